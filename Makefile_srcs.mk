@@ -18,5 +18,25 @@ VVP_SRCS+= ./src/round_arb.v
 VVP_SRCS+= ./src/spi_master.v
 VVP_SRCS+= ./src/ads8688_ui.v
 VVP_SRCS+= ./src/sample_core.v
+VVP_SRCS+= ./src/axi_mem_rd.v
+VVP_SRCS+= ./src/capture_buffer.v
+VVP_SRCS+= ./src/histogram_core.v
+VVP_SRCS+= ./src/ads8684_stat.v
 
 VVP_SRCS+= ./sim/ads8684_wrapper_tb.v
+
+SYN_SRCS=
+
+SYN_SRCS+= ./src/ads8684_conf.v
+SYN_SRCS+= ./src/ads8684_conf_wrapper.v
+SYN_SRCS+= ./src/ads8684_scan.v
+SYN_SRCS+= ./src/ads8684_scan_wrapper.v
+SYN_SRCS+= ./src/ads8684_wrapper.v
+SYN_SRCS+= ./src/round_arb.v
+SYN_SRCS+= ./src/spi_master.v
+SYN_SRCS+= ./src/ads8688_ui.v
+SYN_SRCS+= ./src/sample_core.v
+SYN_SRCS+= ./src/axi_mem_rd.v
+SYN_SRCS+= ./src/capture_buffer.v
+SYN_SRCS+= ./src/histogram_core.v
+SYN_SRCS+= ./src/ads8684_stat.v
@@ -21,10 +21,24 @@
 // ---------------------------------------------------------------------------------------
 
 #include "ads8688.h"
+#include <math.h>
 #include <stddef.h>
 #include <stdlib.h>
 #include <string.h>
 
+// each spi access is atomic under the ctrl lock, a read-modify-write of adc
+// registers and config is not, the helpers below hold the device lock for it
+static void ads8688_dev_lock(ads8688_dev_t *dev)
+{
+    while (atomic_flag_test_and_set_explicit(&dev->lock, memory_order_acquire))
+        ;
+}
+
+static void ads8688_dev_unlock(ads8688_dev_t *dev)
+{
+    atomic_flag_clear_explicit(&dev->lock, memory_order_release);
+}
+
 /**
  * @brief ads8688_write_reg   		ADC 寄存器写入
  * @param *dev                   	ADC 句柄
@@ -93,14 +107,22 @@ int ads8688_reset(ads8688_dev_t *dev)
  */
 int ads8688_set_en(ads8688_dev_t *dev, uint8_t ch, uint8_t en)
 {
+    if (dev == NULL)
+    {
+        return -1;
+    }
+
     uint8_t old_state;
+    ads8688_dev_lock(dev);
     ads8688_read_reg(dev, ADS8688_REG_CH_EN, &old_state);
 
     old_state = (ch == ADS8688_MAX_CH_NUM) ? en
                                            : ((en) ? (uint8_t)(old_state | 1 << ch)
                                                    : (uint8_t)(old_state & ~(1 << ch)));
 
-    return ads8688_write_reg(dev, ADS8688_REG_CH_EN, old_state);
+    int ret = ads8688_write_reg(dev, ADS8688_REG_CH_EN, old_state);
+    ads8688_dev_unlock(dev);
+    return ret;
 }
 
 /**
@@ -112,7 +134,14 @@ int ads8688_set_en(ads8688_dev_t *dev, uint8_t ch, uint8_t en)
  */
 int ads8688_get_en(ads8688_dev_t *dev, uint8_t ch, uint8_t *en)
 {
+    if (dev == NULL || en == NULL)
+    {
+        return -1;
+    }
+
+    ads8688_dev_lock(dev);
     int ret = ads8688_read_reg(dev, ADS8688_REG_CH_EN, en);
+    ads8688_dev_unlock(dev);
     *en = (ch == ADS8688_MAX_CH_NUM) ? (*en) : ((*en >> ch) & 0x01U);
     return ret;
 }
@@ -126,14 +155,22 @@ int ads8688_get_en(ads8688_dev_t *dev, uint8_t ch, uint8_t *en)
  */
 int ads8688_set_pd(ads8688_dev_t *dev, uint8_t ch, uint8_t pd)
 {
+    if (dev == NULL)
+    {
+        return -1;
+    }
+
     uint8_t old_state;
+    ads8688_dev_lock(dev);
     ads8688_read_reg(dev, ADS8688_REG_CH_PD, &old_state);
 
     old_state = (ch == ADS8688_MAX_CH_NUM) ? pd
                                            : ((pd) ? (uint8_t)(old_state | 1 << ch)
                                                    : (uint8_t)(old_state & ~(1 << ch)));
 
-    return ads8688_write_reg(dev, ADS8688_REG_CH_PD, old_state);
+    int ret = ads8688_write_reg(dev, ADS8688_REG_CH_PD, old_state);
+    ads8688_dev_unlock(dev);
+    return ret;
 }
 
 /**
@@ -145,7 +182,14 @@ int ads8688_set_pd(ads8688_dev_t *dev, uint8_t ch, uint8_t pd)
  */
 int ads8688_get_pd(ads8688_dev_t *dev, uint8_t ch, uint8_t *pd)
 {
+    if (dev == NULL || pd == NULL)
+    {
+        return -1;
+    }
+
+    ads8688_dev_lock(dev);
     int ret = ads8688_read_reg(dev, ADS8688_REG_CH_PD, pd);
+    ads8688_dev_unlock(dev);
     *pd = (ch == ADS8688_MAX_CH_NUM) ? (*pd) : ((*pd >> ch) & 0x01U);
     return ret;
 }
@@ -163,7 +207,11 @@ int ads8688_set_range(ads8688_dev_t *dev, uint8_t ch, uint8_t range)
     {
         return -1;
     }
-    return ads8688_write_reg(dev, ADS8688_REG_RANGE_SELECT(ch), range);
+
+    ads8688_dev_lock(dev);
+    int ret = ads8688_write_reg(dev, ADS8688_REG_RANGE_SELECT(ch), range);
+    ads8688_dev_unlock(dev);
+    return ret;
 }
 
 /**
@@ -179,7 +227,11 @@ int ads8688_get_range(ads8688_dev_t *dev, uint8_t ch, uint8_t *range)
     {
         return -1;
     }
-    return ads8688_read_reg(dev, ADS8688_REG_RANGE_SELECT(ch), range);
+
+    ads8688_dev_lock(dev);
+    int ret = ads8688_read_reg(dev, ADS8688_REG_RANGE_SELECT(ch), range);
+    ads8688_dev_unlock(dev);
+    return ret;
 }
 
 int ads8688_set_mode(ads8688_dev_t *dev, enum ADS8688_MODE mode)
@@ -189,57 +241,496 @@ int ads8688_set_mode(ads8688_dev_t *dev, enum ADS8688_MODE mode)
         return -1;
     }
     uint8_t tmp = ((uint8_t)mode & 0x07) | (uint8_t)0B00101000;
+    ads8688_dev_lock(dev);
     ads8688_write_reg(dev, ADS8688_REG_FEATURE_SELECT, tmp);
-    return ads8688_read_reg(dev, ADS8688_REG_FEATURE_SELECT, &tmp);
+    int ret = ads8688_read_reg(dev, ADS8688_REG_FEATURE_SELECT, &tmp);
+    ads8688_dev_unlock(dev);
+    return ret;
+}
+
+/******************************************************************************/
+/************************ Multi-device Access *********************************/
+/******************************************************************************/
+
+// register accesses are queued per device, each wrapper has its own spi engine
+// so the queues of all devices are run in parallel
+#define ADS8688_OP_NUM 32
+
+typedef struct ads8688_op_t
+{
+    uint8_t cmd;    // spi command byte
+    uint8_t wdata;  // write data
+    uint8_t *rdata; // register read back, NULL for write
+} ads8688_op_t;
+
+static int ads8688_op_wr(ads8688_op_t *op, size_t *num, uint8_t addr, uint8_t data)
+{
+    if (*num >= ADS8688_OP_NUM)
+        return -1;
+
+    op[*num].cmd = (addr & 0x80) ? addr : (uint8_t)ADS8688_REG_WR(addr);
+    op[*num].wdata = data;
+    op[*num].rdata = NULL;
+    (*num)++;
+    return 0;
+}
+
+static int ads8688_op_rd(ads8688_op_t *op, size_t *num, uint8_t addr, uint8_t *data)
+{
+    if (*num >= ADS8688_OP_NUM)
+        return -1;
+
+    op[*num].cmd = (uint8_t)ADS8688_REG_RD(addr);
+    op[*num].wdata = 0;
+    op[*num].rdata = data;
+    (*num)++;
+    return 0;
 }
 
 /**
- * @brief ads8688_open   		ADC 打开
- * @param **dev_p               ADC 句柄
- * @param id                    ADC 序号
- * @param channel_en            ADC4 路采样通道使能
- * @return                      0:成功
+ * @brief ads8688_run_ops   		多个 ADC 并行执行寄存器访问队列
+ * @param dev                   ADC 句柄数组
+ * @param op                    每个 ADC 的访问队列
+ * @param op_num                每个 ADC 的队列长度, 0:该 ADC 不参与
+ * @param num                   ADC 数量
+ * @param err                   每个 ADC 的结果, 队列失败时写入第一个错误
+ * @return                      0:成功, 否则为第一个失败队列的错误
  */
-int ads8688_open(ads8688_dev_t **dev_p, int id, int *channel_en, enum ADS8688_RANGE range)
+static int ads8688_run_ops(ads8688_dev_t **dev, ads8688_op_t (*op)[ADS8688_OP_NUM], const size_t *op_num, int num, int *err)
 {
-    if (dev_p == NULL || channel_en == NULL)
-        return -1;
+    size_t idx[ADS8688_MAX_DEV_NUM] = {0};
+    bool pending[ADS8688_MAX_DEV_NUM] = {false};
+    uint32_t ticket[ADS8688_MAX_DEV_NUM] = {0};
+    int ret = 0;
+    int busy;
+
+    do
+    {
+        busy = 0;
+        for (int i = 0; i < num; i++)
+        {
+            ads8688_ctrl_t *spi = dev[i]->spi_desc;
+
+            if (pending[i])
+            {
+                uint16_t rdata = 0;
+                int r = ads8688_spi_complete(spi, ticket[i], &rdata);
+                if (r == 1)
+                {
+                    busy++;
+                    continue;
+                }
+
+                pending[i] = false;
+                if (r < 0)
+                {
+                    // drop the rest of this queue
+                    ret = ret ? ret : r;
+                    err[i] = err[i] ? err[i] : r;
+                    idx[i] = op_num[i];
+                    continue;
+                }
+
+                if (op[i][idx[i]].rdata)
+                    *op[i][idx[i]].rdata = (uint8_t)(rdata >> 8);
+                idx[i]++;
+            }
+
+            if (idx[i] < op_num[i])
+            {
+                int r = ads8688_spi_submit(spi, op[i][idx[i]].cmd, op[i][idx[i]].wdata, &ticket[i]);
+                if (r == 0)
+                {
+                    pending[i] = true;
+                }
+                else if (r != -3)
+                {
+                    ret = ret ? ret : r;
+                    err[i] = err[i] ? err[i] : r;
+                    idx[i] = op_num[i];
+                    continue;
+                }
+                busy++;
+            }
+        }
+    } while (busy);
+
+    return ret;
+}
+
+/**
+ * @brief ads8688_calibrate_devs 	多个 ADC 并行校准 MISO 采样延迟
+ *                              逐个延迟写入/回读通道使能寄存器, 取最长有效窗口的中心
+ *                              通道使能与 SCLK 相位在校准后恢复
+ *                              自动扫描模式下通道使能被扫描通路监听, 不允许校准
+ * @param dev                   ADC 句柄数组
+ * @param num                   ADC 数量
+ * @param err                   每个 ADC 的结果, 0:成功, -2:无有效窗口, -3:自动扫描中
+ * @return                      0:全部成功, 否则为第一个失败 ADC 的错误
+ */
+static int ads8688_calibrate_devs(ads8688_dev_t **dev, int num, int *err)
+{
+    static const uint8_t pattern[] = {0xA5, 0x5A, 0xFF, 0x00};
+
+    ads8688_op_t op[ADS8688_MAX_DEV_NUM][ADS8688_OP_NUM];
+    size_t op_num[ADS8688_MAX_DEV_NUM];
+    uint8_t rd[ADS8688_MAX_DEV_NUM][sizeof(pattern)];
+    uint8_t mask[ADS8688_MAX_DEV_NUM];
+    uint8_t ch_en[ADS8688_MAX_DEV_NUM];
+    uint32_t phase[ADS8688_MAX_DEV_NUM];
+    bool swept[ADS8688_MAX_DEV_NUM];
+    int first[ADS8688_MAX_DEV_NUM];
+    int best[ADS8688_MAX_DEV_NUM];
+    int best_len[ADS8688_MAX_DEV_NUM];
+
+    for (int i = 0; i < num; i++)
+    {
+        first[i] = -1;
+        best[i] = -1;
+        best_len[i] = 0;
+        op_num[i] = 0;
+
+        // the conf fsm is idle in auto mode but ch_en writes still reach the scan path
+        bool auto_mode = false;
+        err[i] = ads8688_get_automode(dev[i]->spi_desc, &auto_mode);
+        if (err[i] == 0 && auto_mode)
+            err[i] = -3;
+        if (err[i])
+            continue;
+
+        // bits above the channel count are reserved and read back as 0
+        mask[i] = (uint8_t)((1U << dev[i]->spi_desc->ch_num.num) - 1U);
+        phase[i] = dev[i]->spi_desc->baud_phase;
+
+        // ch_en is snooped by the scan path, keep it to restore afterwards
+        err[i] = ads8688_op_rd(op[i], &op_num[i], ADS8688_REG_CH_EN, &ch_en[i]);
+        if (err[i])
+            op_num[i] = 0;
+    }
+
+    // nothing is changed yet, without a valid ch_en there is nothing to restore to
+    ads8688_run_ops(dev, op, op_num, num, err);
+
+    for (int i = 0; i < num; i++)
+    {
+        swept[i] = (err[i] == 0);
+    }
+
+    for (int delay = 0; delay <= (int)ADS8688_MISO_DELAY_MAX; delay++)
+    {
+        for (int i = 0; i < num; i++)
+        {
+            op_num[i] = 0;
+            if (err[i])
+                continue;
+
+            err[i] = ads8688_set_spi_timing(dev[i]->spi_desc, phase[i], (uint32_t)delay);
+            if (err[i])
+                continue;
+
+            int r = 0;
+            for (size_t k = 0; k < sizeof(pattern); k++)
+            {
+                rd[i][k] = (uint8_t)~pattern[k];
+                r |= ads8688_op_wr(op[i], &op_num[i], ADS8688_REG_CH_EN, pattern[k] & mask[i]);
+                r |= ads8688_op_rd(op[i], &op_num[i], ADS8688_REG_CH_EN, &rd[i][k]);
+            }
+
+            if (r)
+            {
+                err[i] = r;
+                op_num[i] = 0;
+            }
+        }
+
+        // a wrong delay shows up as a mismatch, a failed transfer is an error
+        ads8688_run_ops(dev, op, op_num, num, err);
+
+        for (int i = 0; i < num; i++)
+        {
+            if (err[i])
+                continue;
+
+            bool pass = true;
+            for (size_t k = 0; k < sizeof(pattern); k++)
+            {
+                pass = pass && ((rd[i][k] & mask[i]) == (pattern[k] & mask[i]));
+            }
+
+            if (!pass)
+            {
+                first[i] = -1;
+                continue;
+            }
+
+            if (first[i] < 0)
+                first[i] = delay;
+
+            if (delay - first[i] + 1 > best_len[i])
+            {
+                best[i] = first[i];
+                best_len[i] = delay - first[i] + 1;
+            }
+        }
+    }
 
-    ads8688_dev_t *ads_handel = (ads8688_dev_t *)calloc(1, sizeof(ads8688_dev_t));
+    // restore timing and ch_en of every swept device even if its sweep failed,
+    // a device without a valid window keeps its previous delay
+    for (int i = 0; i < num; i++)
+    {
+        op_num[i] = 0;
+        if (!swept[i])
+            continue;
+
+        if (err[i] == 0 && best_len[i] == 0)
+            err[i] = -2;
+        else if (err[i] == 0)
+            dev[i]->config.miso_delay = (uint8_t)(best[i] + best_len[i] / 2);
+
+        int r = ads8688_set_spi_timing(dev[i]->spi_desc, phase[i], dev[i]->config.miso_delay);
+        if (r && !err[i])
+            err[i] = r;
+
+        r = ads8688_op_wr(op[i], &op_num[i], ADS8688_REG_CH_EN, ch_en[i]);
+        if (r && !err[i])
+            err[i] = r;
+    }
 
-    /* Initializes the SPI peripheral */
-    int ret = ads8688_spi_init(&ads_handel->spi_desc, id);
-    if (ret)
-        return ret;
+    ads8688_run_ops(dev, op, op_num, num, err);
 
-    ads8688_set_spi_div(ads_handel->spi_desc, (int)(FPGA_CLK_FREQ / ADS8688_MAX_SPI_FREQ));
+    for (int i = 0; i < num; i++)
+    {
+        if (err[i])
+            return err[i];
+    }
 
-    ret = ads8688_reset(ads_handel); // ads 复位
-    if (ret)
-        return ret;
+    return 0;
+}
 
-    ads8688_set_mode(ads_handel, ADS8688_MODE_0);
+/**
+ * @brief ads8688_free_dev   	释放 ADC 句柄
+ * @param **dev                 ADC 句柄, 释放后置为 NULL
+ */
+static void ads8688_free_dev(ads8688_dev_t **dev)
+{
+    if (*dev)
+    {
+        free((*dev)->spi_desc);
+        free(*dev);
+        *dev = NULL;
+    }
+}
 
-    for (size_t i = 0; i < ADS8688_MAX_CH_NUM; i++)
+/**
+ * @brief ads8688_drop_failed   	释放上一步失败的 ADC, 其余 ADC 保持顺序
+ * @param dev                   仍在打开的 ADC 句柄数组
+ * @param map                   每个 ADC 在调用者数组中的序号
+ * @param dev_err               上一步每个 ADC 的结果
+ * @param num                   ADC 数量
+ * @param err                   调用者数组中每个 ADC 的结果
+ * @return                      剩余 ADC 数量
+ */
+static int ads8688_drop_failed(ads8688_dev_t **dev, int *map, const int *dev_err, int num, int *err)
+{
+    int n = 0;
+    for (int i = 0; i < num; i++)
     {
-        ads8688_set_range(ads_handel, (uint8_t)i, (uint8_t)range);
-        ads8688_get_range(ads_handel, (uint8_t)i, &ads_handel->config.range[i]);
+        if (dev_err[i])
+        {
+            err[map[i]] = dev_err[i];
+            ads8688_free_dev(&dev[i]);
+            continue;
+        }
+
+        dev[n] = dev[i];
+        map[n] = map[i];
+        n++;
     }
+    return n;
+}
 
-    uint8_t ch_en = (uint8_t)(channel_en[0] + (channel_en[1] << 1) + (channel_en[2] << 2) + (channel_en[3] << 3));
+/**
+ * @brief ads8688_open_devs   	多个 ADC 并行打开, 失败的 ADC 单独释放, 不影响其余 ADC
+ * @param **dev_p               ADC 句柄数组, 失败的 ADC 置为 NULL
+ * @param id                    ADC 序号数组
+ * @param num                   ADC 数量
+ * @param channel_en            每个 ADC 的通道使能
+ * @return                      0:全部成功, 否则为第一个失败 ADC 的错误
+ */
+static int ads8688_open_devs(ads8688_dev_t **dev_p, const int *id, int num, int **channel_en, enum ADS8688_RANGE range)
+{
+    ads8688_dev_t *dev[ADS8688_MAX_DEV_NUM];
+    int map[ADS8688_MAX_DEV_NUM];
+    int dev_err[ADS8688_MAX_DEV_NUM];
+    int err[ADS8688_MAX_DEV_NUM] = {0};
+    ads8688_op_t op[ADS8688_MAX_DEV_NUM][ADS8688_OP_NUM];
+    size_t op_num[ADS8688_MAX_DEV_NUM];
+    uint8_t mode[ADS8688_MAX_DEV_NUM];
+    int n = 0;
+
+    for (int i = 0; i < num; i++)
+    {
+        dev_p[i] = NULL;
+
+        if (channel_en[i] == NULL)
+        {
+            err[i] = -1;
+            continue;
+        }
+
+        ads8688_dev_t *d = (ads8688_dev_t *)calloc(1, sizeof(ads8688_dev_t));
+        if (d == NULL)
+        {
+            err[i] = -1;
+            continue;
+        }
+
+        atomic_flag_clear(&d->lock);
+
+        /* Initializes the SPI peripheral */
+        err[i] = ads8688_spi_init(&d->spi_desc, id[i]);
+        if (err[i])
+        {
+            ads8688_free_dev(&d);
+            continue;
+        }
+
+        ads8688_set_spi_div(d->spi_desc, (int)ceilf(FPGA_CLK_FREQ / ADS8688_MAX_SPI_FREQ));
+
+        dev[n] = d;
+        map[n] = i;
+        n++;
+    }
 
-    ads8688_set_en(ads_handel, ADS8688_MAX_CH_NUM, ch_en);
-    ads8688_get_en(ads_handel, ADS8688_MAX_CH_NUM, &ads_handel->config.channel_en);
-    ads8688_set_pd(ads_handel, ADS8688_MAX_CH_NUM, ~ch_en);
-    ads8688_get_pd(ads_handel, ADS8688_MAX_CH_NUM, &ads_handel->config.channel_pd);
+    for (int i = 0; i < n; i++)
+    {
+        op_num[i] = 0;
+        dev_err[i] = ads8688_op_wr(op[i], &op_num[i], ADS8688_REG_RST, 0); // ads 复位
+    }
 
-    ads_handel->is_opened = 1;
+    ads8688_run_ops(dev, op, op_num, n, dev_err);
+    n = ads8688_drop_failed(dev, map, dev_err, n, err);
 
-    *dev_p = ads_handel;
+    ads8688_calibrate_devs(dev, n, dev_err); // miso 采样延迟校准
+    n = ads8688_drop_failed(dev, map, dev_err, n, err);
+
+    for (int i = 0; i < n; i++)
+    {
+        ads8688_config_t *config = &dev[i]->config;
+        uint32_t ch_num = dev[i]->spi_desc->ch_num.num;
+        int *en = channel_en[map[i]];
+        int r = 0;
+
+        op_num[i] = 0;
+
+        uint8_t tmp = ((uint8_t)ADS8688_MODE_0 & 0x07) | (uint8_t)0B00101000;
+        r |= ads8688_op_wr(op[i], &op_num[i], ADS8688_REG_FEATURE_SELECT, tmp);
+        r |= ads8688_op_rd(op[i], &op_num[i], ADS8688_REG_FEATURE_SELECT, &mode[i]);
+
+        for (uint32_t ch = 0; ch < ch_num; ch++)
+        {
+            r |= ads8688_op_wr(op[i], &op_num[i], (uint8_t)ADS8688_REG_RANGE_SELECT(ch), (uint8_t)range);
+            r |= ads8688_op_rd(op[i], &op_num[i], (uint8_t)ADS8688_REG_RANGE_SELECT(ch), &config->range[ch]);
+        }
+
+        uint8_t ch_en = 0;
+        for (uint32_t ch = 0; ch < ch_num; ch++)
+        {
+            ch_en |= (uint8_t)((en[ch] ? 1U : 0U) << ch);
+        }
+
+        r |= ads8688_op_wr(op[i], &op_num[i], ADS8688_REG_CH_EN, ch_en);
+        r |= ads8688_op_rd(op[i], &op_num[i], ADS8688_REG_CH_EN, &config->channel_en);
+        r |= ads8688_op_wr(op[i], &op_num[i], ADS8688_REG_CH_PD, (uint8_t)~ch_en);
+        r |= ads8688_op_rd(op[i], &op_num[i], ADS8688_REG_CH_PD, &config->channel_pd);
+
+        dev_err[i] = r;
+        if (r)
+            op_num[i] = 0;
+    }
+
+    ads8688_run_ops(dev, op, op_num, n, dev_err);
+    n = ads8688_drop_failed(dev, map, dev_err, n, err);
+
+    for (int i = 0; i < n; i++)
+    {
+        // aux channel is not part of the device sequence, the core appends it
+        uint32_t ch_num = dev[i]->spi_desc->ch_num.num;
+        if (dev[i]->spi_desc->ch_num.aux)
+        {
+            dev[i]->config.aux_en = channel_en[map[i]][ch_num] ? 1 : 0;
+            ads8688_set_aux_en(dev[i]->spi_desc, dev[i]->config.aux_en);
+        }
+
+        dev[i]->is_opened = 1;
+        dev_p[map[i]] = dev[i];
+    }
+
+    for (int i = 0; i < num; i++)
+    {
+        if (err[i])
+            return err[i];
+    }
 
     return 0;
 }
 
+/**
+ * @brief ads8688_calibrate   	MISO 采样延迟校准, 须在自动扫描停止后调用
+ * @param dev                   ADC 句柄
+ * @return                      0:成功, -2:无有效窗口, -3:自动扫描中
+ */
+int ads8688_calibrate(ads8688_dev_t *dev)
+{
+    if (dev == NULL)
+    {
+        return -1;
+    }
+
+    // the sweep overwrites ch_en, keep the other helpers out until restored
+    int err;
+    ads8688_dev_lock(dev);
+    int ret = ads8688_calibrate_devs(&dev, 1, &err);
+    ads8688_dev_unlock(dev);
+    return ret;
+}
+
+/**
+ * @brief ads8688_open   		ADC 打开
+ * @param **dev_p               ADC 句柄
+ * @param id                    ADC 序号
+ * @param channel_en            ADC 各通道使能, 长度为通道数量, 带 AUX 通道时最后一个为 AUX 通道
+ * @return                      0:成功
+ */
+int ads8688_open(ads8688_dev_t **dev_p, int id, int *channel_en, enum ADS8688_RANGE range)
+{
+    if (dev_p == NULL || channel_en == NULL)
+        return -1;
+
+    return ads8688_open_devs(dev_p, &id, 1, &channel_en, range);
+}
+
+/**
+ * @brief ads8688_open_multi   	多个 ADC 并行打开, 各 ADC 的 SPI 传输交替进行
+ * @param **dev_p               ADC 句柄数组, 长度为 num, 打开失败的 ADC 置为 NULL
+ * @param num                   ADC 数量, 打开序号 0 ~ num-1
+ * @param channel_en            每个 ADC 的通道使能, 格式同 ads8688_open
+ * @return                      0:全部成功, 否则为第一个失败 ADC 的错误, 其余 ADC 仍然打开
+ */
+int ads8688_open_multi(ads8688_dev_t **dev_p, int num, int **channel_en, enum ADS8688_RANGE range)
+{
+    if (dev_p == NULL || channel_en == NULL || num <= 0 || num > ADS8688_MAX_DEV_NUM)
+        return -1;
+
+    int id[ADS8688_MAX_DEV_NUM];
+    for (int i = 0; i < num; i++)
+    {
+        id[i] = i;
+    }
+
+    return ads8688_open_devs(dev_p, id, num, channel_en, range);
+}
+
 /**
  * @brief ads8688_close   		ADC 关闭
  * @param **dev_p               ADC 句柄
@@ -254,13 +745,16 @@ int ads8688_close(ads8688_dev_t **dev_p)
 
     if ((*dev_p)->is_opened)
     {
+        ads8688_dev_lock(*dev_p);
         (*dev_p)->config.channel_en = 0;
         (*dev_p)->config.channel_pd = 0xff;
 
-        ads8688_set_en(*dev_p, ADS8688_MAX_CH_NUM, (*dev_p)->config.channel_en);
-        ads8688_set_pd(*dev_p, ADS8688_MAX_CH_NUM, (*dev_p)->config.channel_pd);
+        ads8688_write_reg(*dev_p, ADS8688_REG_CH_EN, (*dev_p)->config.channel_en);
+        ads8688_write_reg(*dev_p, ADS8688_REG_CH_PD, (*dev_p)->config.channel_pd);
+        ads8688_dev_unlock(*dev_p);
     }
 
+    free((*dev_p)->spi_desc);
     free(*dev_p);
     *dev_p = NULL;
 
@@ -33,6 +33,7 @@
 /************************ Include Files ***************************************/
 /******************************************************************************/
 
+#include <stdatomic.h>
 #include <stdbool.h>
 #include <stdint.h>
 #include "ads8688_ctrl.h"
@@ -85,6 +86,8 @@ typedef struct ads8688_config_t
 {
     uint8_t channel_en; // 每个 bit 代表一个通道
     uint8_t channel_pd; // 每个 bit 代表一个通道	powerdown
+    uint8_t aux_en;     // AUX 通道参与扫描
+    uint8_t miso_delay; // MISO 采样延迟
     uint8_t range[8];
 } ads8688_config_t;
 
@@ -93,12 +96,15 @@ typedef struct ads8688_dev_t
     ads8688_ctrl_t *spi_desc; /* SPI */
     ads8688_config_t config;  /* Device Settings */
     int is_opened;
+    atomic_flag lock;         /* guards config and register read-modify-write */
 } ads8688_dev_t;
 
 /******************************************************************************/
 /************************ Functions Declarations ******************************/
 /******************************************************************************/
+extern int ads8688_calibrate(ads8688_dev_t *dev);
 extern int ads8688_open(ads8688_dev_t **dev_p, int id, int *channel_en, enum ADS8688_RANGE range);
+extern int ads8688_open_multi(ads8688_dev_t **dev_p, int num, int **channel_en, enum ADS8688_RANGE range);
 extern int ads8688_close(ads8688_dev_t **dev_p);
 
 /******************************************************************************/
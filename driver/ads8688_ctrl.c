@@ -23,18 +23,56 @@
 #include "ads8688_ctrl.h"
 #include "ads8688.h"
 #include "xparameters.h"
+#include <math.h>
 #include <stdlib.h>
 
 extern int reg_read32(uint32_t addr, uint32_t *value);
 extern int reg_write32(uint32_t addr, const uint32_t *value);
 
-uint32_t adc_baseaddr[4] = {
+uint32_t adc_baseaddr[ADS8688_MAX_DEV_NUM] = {
     XPAR_AD_H_ADS8684_WRAPPER_0_BASEADDR,
     XPAR_AD_H_ADS8684_WRAPPER_1_BASEADDR,
     XPAR_AD_H_ADS8684_WRAPPER_2_BASEADDR,
     XPAR_AD_H_ADS8684_WRAPPER_3_BASEADDR,
 };
 
+// memory window of the capture buffer, only present when C_BUF_DEPTH > 0
+#ifdef XPAR_AD_H_ADS8684_WRAPPER_0_S_AXI_BASEADDR
+uint32_t adc_bufaddr[ADS8688_MAX_DEV_NUM] = {
+    XPAR_AD_H_ADS8684_WRAPPER_0_S_AXI_BASEADDR,
+    XPAR_AD_H_ADS8684_WRAPPER_1_S_AXI_BASEADDR,
+    XPAR_AD_H_ADS8684_WRAPPER_2_S_AXI_BASEADDR,
+    XPAR_AD_H_ADS8684_WRAPPER_3_S_AXI_BASEADDR,
+};
+#else
+uint32_t adc_bufaddr[ADS8688_MAX_DEV_NUM] = {0};
+#endif
+
+// memory window of the histogram, only present when C_HIST_BIN_WIDTH > 0
+#ifdef XPAR_AD_H_ADS8684_WRAPPER_0_S_HIST_AXI_BASEADDR
+uint32_t adc_histaddr[ADS8688_MAX_DEV_NUM] = {
+    XPAR_AD_H_ADS8684_WRAPPER_0_S_HIST_AXI_BASEADDR,
+    XPAR_AD_H_ADS8684_WRAPPER_1_S_HIST_AXI_BASEADDR,
+    XPAR_AD_H_ADS8684_WRAPPER_2_S_HIST_AXI_BASEADDR,
+    XPAR_AD_H_ADS8684_WRAPPER_3_S_HIST_AXI_BASEADDR,
+};
+#else
+uint32_t adc_histaddr[ADS8688_MAX_DEV_NUM] = {0};
+#endif
+
+// ctrl is shared by several functions through read-modify-write, the spi
+// engine takes a few register accesses to set up, both are done under the lock
+static void ads8688_lock(ads8688_ctrl_t *dev)
+{
+    while (atomic_flag_test_and_set_explicit(&dev->lock, memory_order_acquire))
+        ;
+}
+
+static void ads8688_unlock(ads8688_ctrl_t *dev)
+{
+    atomic_flag_clear_explicit(&dev->lock, memory_order_release);
+}
+
 /***************************************************************************
  * @brief reset the ads8688 chip
  *
@@ -48,23 +86,43 @@ int ads8688_soft_rst(ads8688_ctrl_t *dev)
     if (dev == NULL)
         return -1;
 
+    ads8688_lock(dev);
     dev->ctrl.all = 0;
     dev->ctrl.soft_rst = 1;
     reg_write32(dev->base_addr + offsetof(ads8688_ctrl_t, ctrl), &dev->ctrl.all);
+    ads8688_unlock(dev);
 
+    bool busy;
     do
     {
+        ads8688_lock(dev);
         reg_read32(dev->base_addr + offsetof(ads8688_ctrl_t, ctrl), &dev->ctrl.all);
+        busy = dev->ctrl.soft_rst;
+        ads8688_unlock(dev);
 
         // !todo: time out check
         // if (timeout)
         //    return -5;
 
-    } while (dev->ctrl.soft_rst);
+    } while (busy);
 
     return 0;
 }
 
+/***************************************************************************
+ * @brief set auto sample mode, the caller holds the lock
+ *
+ * @param dev           - The device structure.
+ * @param en            - Auto sample mode.
+ *******************************************************************************/
+static void ads8688_write_automode(ads8688_ctrl_t *dev, bool en)
+{
+    // read back ctrl reg
+    reg_read32(dev->base_addr + offsetof(ads8688_ctrl_t, ctrl), &dev->ctrl.all);
+    dev->ctrl.cfg_auto_mode = en;
+    reg_write32(dev->base_addr + offsetof(ads8688_ctrl_t, ctrl), &dev->ctrl.all);
+}
+
 /***************************************************************************
  * @brief set auto sample mode
  *
@@ -78,14 +136,131 @@ int ads8688_set_automode(ads8688_ctrl_t *dev, bool en)
     if (dev == NULL)
         return -1;
 
+    ads8688_lock(dev);
+    ads8688_write_automode(dev, en);
+    ads8688_unlock(dev);
+
+    return 0;
+}
+
+/***************************************************************************
+ * @brief get auto sample mode
+ *
+ * @param dev           - The device structure.
+ * @param en            - Auto sample mode is on.
+ *
+ * @return 0 for success or negative error code.
+ *******************************************************************************/
+int ads8688_get_automode(ads8688_ctrl_t *dev, bool *en)
+{
+    // check if dev is valid
+    if (dev == NULL || en == NULL)
+        return -1;
+
+    ads8688_lock(dev);
+    reg_read32(dev->base_addr + offsetof(ads8688_ctrl_t, ctrl), &dev->ctrl.all);
+    *en = dev->ctrl.cfg_auto_mode;
+    ads8688_unlock(dev);
+
+    return 0;
+}
+
+/***************************************************************************
+ * @brief add the aux channel to the auto scan sequence
+ *
+ * @param dev           - The device structure.
+ * @param en            - Scan the aux channel after the last enabled channel.
+ *
+ * @return 0 for success or negative error code.
+ *******************************************************************************/
+int ads8688_set_aux_en(ads8688_ctrl_t *dev, bool en)
+{
+    // check if dev is valid
+    if (dev == NULL)
+        return -1;
+
+    // check if aux channel is available
+    if (en && !dev->ch_num.aux)
+        return -2;
+
     // read back ctrl reg
+    ads8688_lock(dev);
     reg_read32(dev->base_addr + offsetof(ads8688_ctrl_t, ctrl), &dev->ctrl.all);
-    dev->ctrl.cfg_auto_mode = en;
+    dev->ctrl.aux_en = en;
     reg_write32(dev->base_addr + offsetof(ads8688_ctrl_t, ctrl), &dev->ctrl.all);
+    ads8688_unlock(dev);
+
+    return 0;
+}
+
+/***************************************************************************
+ * @brief convert a sample rate into the 32.32 scan period, the caller holds the lock
+ *
+ * @param dev           - The device structure, channel_en must be up to date.
+ * @param sample_rate   - The taget sample rete , points per second,
+ *  a value of 0 to disable sample.
+ *
+ * @return 0 for success or negative error code.
+ *******************************************************************************/
+static int ads8688_calc_scan_period(ads8688_ctrl_t *dev, double sample_rate)
+{
+    if ((sample_rate == 0) || (dev->channel_en == 0))
+    {
+        dev->scan_period = 0;
+        dev->scan_frac = 0;
+        return 0;
+    }
+
+    double period = FPGA_CLK_FREQ / sample_rate;
+    if (period < 1.0 || period >= 4294967296.0)
+        return -2;
+
+    // one spi frame per enabled channel, the aux channel included
+    uint32_t frames = 0;
+    for (uint32_t en = dev->channel_en & 0x1FFU; en; en >>= 1)
+        frames += en & 1U;
+
+    // the scan can not be shorter than the spi transfers it contains, cs is
+    // held for miso_delay more clocks until the last delayed bit is captured.
+    // a scan that does not follow the previous one back to back restarts the
+    // sequence with an auto_rst command frame, so one more frame is charged
+    reg_read32(dev->base_addr + offsetof(ads8688_ctrl_t, baud_div), &dev->baud_div);
+    reg_read32(dev->base_addr + offsetof(ads8688_ctrl_t, miso_delay), &dev->miso_delay);
+    if (period < (double)(frames + 1) * (ADS8688_FRAME_BITS * dev->baud_div + ADS8688_FRAME_GAP + dev->miso_delay))
+        return -5;
+
+    // split into integer and fraction, period * 2^32 does not fit a long long
+    double whole = floor(period);
+    double frac = round((period - whole) * 4294967296.0);
+    if (frac >= 4294967296.0)
+    {
+        whole += 1.0;
+        frac = 0;
+    }
+
+    if (whole >= 4294967296.0)
+        return -2;
+
+    dev->scan_period = (uint32_t)whole;
+    dev->scan_frac = (uint32_t)frac;
 
     return 0;
 }
 
+/***************************************************************************
+ * @brief write the scan period computed by ads8688_calc_scan_period, the
+ *  caller holds the lock
+ *
+ * @param dev           - The device structure.
+ *******************************************************************************/
+static void ads8688_write_scan_period(ads8688_ctrl_t *dev)
+{
+    reg_write32(dev->base_addr + offsetof(ads8688_ctrl_t, scan_frac), &dev->scan_frac);
+    reg_write32(dev->base_addr + offsetof(ads8688_ctrl_t, scan_period), &dev->scan_period);
+    reg_read32(dev->base_addr + offsetof(ads8688_ctrl_t, scan_frac), &dev->scan_frac);
+    reg_read32(dev->base_addr + offsetof(ads8688_ctrl_t, scan_period), &dev->scan_period);
+}
+
 /***************************************************************************
  * @brief set sample rate of adc chip
  *
@@ -109,10 +284,13 @@ int ads8688_start_sample(ads8688_ctrl_t *dev, uint32_t sample_num, uint32_t samp
     if (sample_rate > FPGA_CLK_FREQ || sample_rate < 0)
         return -2;
 
+    ads8688_lock(dev);
+
     // check if any channel is enabled
     reg_read32(dev->base_addr + offsetof(ads8688_ctrl_t, channel_en), &dev->channel_en);
     if (!dev->channel_en)
     {
+        ads8688_unlock(dev);
         return -3;
     }
 
@@ -120,19 +298,21 @@ int ads8688_start_sample(ads8688_ctrl_t *dev, uint32_t sample_num, uint32_t samp
     reg_read32(dev->base_addr + offsetof(ads8688_ctrl_t, status), &dev->status.all);
     if (dev->status.sample_busy)
     {
+        ads8688_unlock(dev);
         return -4;
     }
 
-    if ((sample_rate != 0) && (dev->channel_en != 0))
-        dev->scan_period = FPGA_CLK_FREQ / sample_rate;
-    else
-        dev->scan_period = 0;
+    int ret = ads8688_calc_scan_period(dev, sample_rate);
+    if (ret)
+    {
+        ads8688_unlock(dev);
+        return ret;
+    }
 
-    ads8688_set_automode(dev, 0);
+    ads8688_write_automode(dev, 0);
 
     // set sample rate
-    reg_write32(dev->base_addr + offsetof(ads8688_ctrl_t, scan_period), &dev->scan_period);
-    reg_read32(dev->base_addr + offsetof(ads8688_ctrl_t, scan_period), &dev->scan_period);
+    ads8688_write_scan_period(dev);
 
     // set sample num
     reg_write32(dev->base_addr + offsetof(ads8688_ctrl_t, sample_num), &sample_num);
@@ -145,9 +325,11 @@ int ads8688_start_sample(ads8688_ctrl_t *dev, uint32_t sample_num, uint32_t samp
         reg_read32(dev->base_addr + offsetof(ads8688_ctrl_t, ctrl), &dev->ctrl.all);
         dev->ctrl.sample_req = 1;
         reg_write32(dev->base_addr + offsetof(ads8688_ctrl_t, ctrl), &dev->ctrl.all);
-        ads8688_set_automode(dev, 1);
+        ads8688_write_automode(dev, 1);
     }
 
+    ads8688_unlock(dev);
+
     return 0;
 }
 
@@ -161,6 +343,8 @@ int ads8688_sample_check(ads8688_ctrl_t *dev)
     if (dev == NULL)
         return -1;
 
+    ads8688_lock(dev);
+
     // wait until spi is done, this step may not be nessary for pc
     reg_read32(dev->base_addr + offsetof(ads8688_ctrl_t, status), &dev->status.all);
     if (dev->status.sample_busy)
@@ -169,21 +353,27 @@ int ads8688_sample_check(ads8688_ctrl_t *dev)
         reg_read32(dev->base_addr + offsetof(ads8688_ctrl_t, channel_en), &dev->channel_en);
         reg_read32(dev->base_addr + offsetof(ads8688_ctrl_t, sample_cnt), &dev->sample_cnt);
         reg_read32(dev->base_addr + offsetof(ads8688_ctrl_t, sample_num), &dev->sample_num);
+        ads8688_unlock(dev);
         return 1;
     }
     else
     {
-        ads8688_set_automode(dev, 0);
+        ads8688_write_automode(dev, 0);
         reg_read32(dev->base_addr + offsetof(ads8688_ctrl_t, sample_cnt), &dev->sample_cnt);
         if (dev->status.sample_err || (dev->sample_cnt != 0))
         {
-            uint32_t clear = 0xff;
-            reg_write32(dev->base_addr + offsetof(ads8688_ctrl_t, status), &clear);
+            // status is shared with the spi engine, only clear the sample flags
+            ads8688_ctrl_status_t clear = {.all = 0};
+            clear.sample_err = 1;
+            clear.sample_done = 1;
+            reg_write32(dev->base_addr + offsetof(ads8688_ctrl_t, status), &clear.all);
+            ads8688_unlock(dev);
             return -2;
         }
     }
 
     reg_read32(dev->base_addr + offsetof(ads8688_ctrl_t, sample_num), &dev->sample_num);
+    ads8688_unlock(dev);
 
     return 0;
 }
@@ -207,103 +397,567 @@ int ads8688_set_sample_rate(ads8688_ctrl_t *dev, double sample_rate)
     if (sample_rate > FPGA_CLK_FREQ || sample_rate < 0)
         return -2;
 
+    ads8688_lock(dev);
+
     // check if any channel is enabled
     reg_read32(dev->base_addr + offsetof(ads8688_ctrl_t, channel_en), &dev->channel_en);
 
-    if ((sample_rate != 0) && (dev->channel_en != 0))
-        dev->scan_period = FPGA_CLK_FREQ / sample_rate;
-    else
-        dev->scan_period = 0;
+    int ret = ads8688_calc_scan_period(dev, sample_rate);
+    if (ret)
+    {
+        ads8688_unlock(dev);
+        return ret;
+    }
 
     // disbale auto scan
-    reg_read32(dev->base_addr + offsetof(ads8688_ctrl_t, ctrl), &dev->ctrl.all);
-    dev->ctrl.cfg_auto_mode = 0;
-    reg_write32(dev->base_addr + offsetof(ads8688_ctrl_t, ctrl), &dev->ctrl.all);
+    ads8688_write_automode(dev, 0);
 
     // set sample rate
-    reg_write32(dev->base_addr + offsetof(ads8688_ctrl_t, scan_period), &dev->scan_period);
-    reg_read32(dev->base_addr + offsetof(ads8688_ctrl_t, scan_period), &dev->scan_period);
+    ads8688_write_scan_period(dev);
 
     // enable auto scan
     if (dev->scan_period > 0)
+        ads8688_write_automode(dev, 1);
+
+    ads8688_unlock(dev);
+
+    return 0;
+}
+
+/***************************************************************************
+ * @brief get the sample rate actually produced by the scan timer
+ *
+ * @param dev           - The device structure.
+ * @param sample_rate   - The achieved sample rete , points per second,
+ *  0 when sample is disabled.
+ *
+ * @return 0 for success or negative error code.
+ *******************************************************************************/
+int ads8688_get_sample_rate(ads8688_ctrl_t *dev, double *sample_rate)
+{
+    // check if dev is valid
+    if (dev == NULL || sample_rate == NULL)
+        return -1;
+
+    ads8688_lock(dev);
+    reg_read32(dev->base_addr + offsetof(ads8688_ctrl_t, scan_period), &dev->scan_period);
+    reg_read32(dev->base_addr + offsetof(ads8688_ctrl_t, scan_frac), &dev->scan_frac);
+    uint32_t scan_period = dev->scan_period;
+    uint32_t scan_frac = dev->scan_frac;
+    ads8688_unlock(dev);
+
+    if (scan_period == 0)
     {
-        reg_read32(dev->base_addr + offsetof(ads8688_ctrl_t, ctrl), &dev->ctrl.all);
-        dev->ctrl.cfg_auto_mode = 1;
-        reg_write32(dev->base_addr + offsetof(ads8688_ctrl_t, ctrl), &dev->ctrl.all);
+        *sample_rate = 0;
+        return 0;
     }
 
+    *sample_rate = FPGA_CLK_FREQ / (scan_period + scan_frac / 4294967296.0);
+
     return 0;
 }
 
 /***************************************************************************
- * @brief Writes data into a register.
+ * @brief start continuous capture into the on-chip ping-pong buffer
  *
- * @param dev      - The device structure.
- * @param spi_addr - The address of the register to be written.
- * @param spi_data  - The value to be written into the register.
+ * @param dev           - The device structure.
+ * @param sample_rate   - The taget sample rete , points per second.
  *
- * @return Returns 0 in case of success or negative error code.
+ * @return 0 for success or negative error code.
  *******************************************************************************/
-int ads8688_spi_transfer(ads8688_ctrl_t *dev, uint8_t spi_addr, uint16_t spi_wdata, uint16_t *spi_rdata)
+int ads8688_buf_start(ads8688_ctrl_t *dev, double sample_rate)
 {
     // check if dev is valid
     if (dev == NULL)
         return -1;
 
-    // !todo: check if spi_addr is valid
-    // if (...)
-    //    return -2;
+    // check if capture buffer is present
+    ads8688_lock(dev);
+    reg_read32(dev->base_addr + offsetof(ads8688_ctrl_t, buf_size), &dev->buf_size);
+    uint32_t buf_size = dev->buf_size;
+    ads8688_unlock(dev);
+    if (buf_size == 0 || dev->buf_addr == 0)
+        return -2;
 
-    // check if spi is busy
-    reg_read32(dev->base_addr + offsetof(ads8688_ctrl_t, status), &dev->status.all);
-    if (dev->status.spi_busy)
-        return -3;
+    // check if sample_rate is valid
+    if (sample_rate <= 0)
+        return -2;
 
-    // set addr
-    reg_write32(dev->base_addr + offsetof(ads8688_ctrl_t, addr), (uint32_t *)&spi_addr);
+    // stop scanning and reset the write pointer
+    ads8688_buf_stop(dev);
 
-    // set write data
-    reg_write32(dev->base_addr + offsetof(ads8688_ctrl_t, wr_data), (uint32_t *)&spi_wdata);
+    ads8688_lock(dev);
 
-    // set addr
-    reg_read32(dev->base_addr + offsetof(ads8688_ctrl_t, addr), (uint32_t *)&dev->addr);
+    // release both banks and clear overflow flag
+    dev->buf_ctrl.all = 0;
+    dev->buf_ctrl.release = 0x3;
+    reg_write32(dev->base_addr + offsetof(ads8688_ctrl_t, buf_ctrl), &dev->buf_ctrl.all);
+    dev->buf_state.all = 0xffffffff;
+    reg_write32(dev->base_addr + offsetof(ads8688_ctrl_t, buf_state), &dev->buf_state.all);
+    dev->buf_rd_bank = 0;
 
-    // set write data
-    reg_read32(dev->base_addr + offsetof(ads8688_ctrl_t, wr_data), (uint32_t *)&dev->wr_data);
+    // enable buffer
+    dev->buf_ctrl.all = 0;
+    dev->buf_ctrl.enable = 1;
+    reg_write32(dev->base_addr + offsetof(ads8688_ctrl_t, buf_ctrl), &dev->buf_ctrl.all);
 
-    // read back ctrl reg
-    reg_read32(dev->base_addr + offsetof(ads8688_ctrl_t, ctrl), &dev->ctrl.all);
+    ads8688_unlock(dev);
+
+    // start auto scan
+    return ads8688_set_sample_rate(dev, sample_rate);
+}
+
+/***************************************************************************
+ * @brief stop continuous capture
+ *
+ * @param dev           - The device structure.
+ *
+ * @return 0 for success or negative error code.
+ *******************************************************************************/
+int ads8688_buf_stop(ads8688_ctrl_t *dev)
+{
+    // check if dev is valid
+    if (dev == NULL)
+        return -1;
+
+    ads8688_lock(dev);
+    ads8688_write_automode(dev, 0);
+
+    dev->buf_ctrl.all = 0;
+    reg_write32(dev->base_addr + offsetof(ads8688_ctrl_t, buf_ctrl), &dev->buf_ctrl.all);
+    ads8688_unlock(dev);
+
+    return 0;
+}
+
+/***************************************************************************
+ * @brief copy out a filled half of the capture buffer and hand it back to
+ *  the hardware, halves are read alternately starting from bank 0
+ *
+ * @param dev           - The device structure.
+ * @param buf           - Destination, at least buf_size bytes.
+ * @param size          - Size of destination in bytes.
+ * @param wrap          - Optional, wrap counter at the time of reading.
+ *
+ * @return 0 for success, 1 if no half is filled yet or negative error code.
+ *******************************************************************************/
+int ads8688_buf_read(ads8688_ctrl_t *dev, void *buf, uint32_t size, uint32_t *wrap)
+{
+    // check if dev is valid
+    if (dev == NULL || buf == NULL)
+        return -1;
+
+    ads8688_lock(dev);
+
+    // check if destination is large enough
+    uint32_t buf_size = dev->buf_size;
+    if (buf_size == 0 || size < buf_size)
+    {
+        ads8688_unlock(dev);
+        return -2;
+    }
+
+    reg_read32(dev->base_addr + offsetof(ads8688_ctrl_t, buf_state), &dev->buf_state.all);
+    ads8688_ctrl_buf_state_t buf_state = dev->buf_state;
+    uint32_t rd_bank = dev->buf_rd_bank;
+    if (!(buf_state.full & (1U << rd_bank)))
+    {
+        ads8688_unlock(dev);
+        return 1;
+    }
+
+    if (wrap)
+    {
+        reg_read32(dev->base_addr + offsetof(ads8688_ctrl_t, buf_wrap), &dev->buf_wrap);
+        *wrap = dev->buf_wrap;
+    }
+
+    ads8688_unlock(dev);
+
+    // the bank belongs to software until released, copy it without the lock
+    uint32_t *dst = (uint32_t *)buf;
+    uint32_t src = dev->buf_addr + rd_bank * buf_size;
+    for (uint32_t i = 0; i < buf_size / sizeof(uint32_t); i++)
+    {
+        reg_read32(src + i * sizeof(uint32_t), &dst[i]);
+    }
+
+    ads8688_lock(dev);
+
+    // hand the bank back to the hardware
+    dev->buf_ctrl.all = 0;
+    dev->buf_ctrl.enable = 1;
+    dev->buf_ctrl.release = 1U << rd_bank;
+    reg_write32(dev->base_addr + offsetof(ads8688_ctrl_t, buf_ctrl), &dev->buf_ctrl.all);
+    dev->buf_rd_bank = rd_bank ^ 1;
+
+    // samples were dropped while both halves were full
+    if (buf_state.overflow)
+    {
+        uint32_t clear = 0xffffffff;
+        reg_write32(dev->base_addr + offsetof(ads8688_ctrl_t, buf_state), &clear);
+        ads8688_unlock(dev);
+        return -5;
+    }
+
+    ads8688_unlock(dev);
+
+    return 0;
+}
+
+/***************************************************************************
+ * @brief clear the histogram and start accumulating codes of one channel
+ *
+ * @param dev           - The device structure.
+ * @param ch            - Channel to accumulate.
+ * @param limit         - Number of samples to accumulate, 0 for no limit.
+ * @param sample_rate   - The taget sample rete , points per second.
+ *
+ * @return 0 for success or negative error code.
+ *******************************************************************************/
+int ads8688_hist_start(ads8688_ctrl_t *dev, uint32_t ch, uint32_t limit, double sample_rate)
+{
+    // check if dev is valid
+    if (dev == NULL)
+        return -1;
+
+    // check if histogram is present
+    ads8688_lock(dev);
+    reg_read32(dev->base_addr + offsetof(ads8688_ctrl_t, hist_size), &dev->hist_size);
+    uint32_t hist_size = dev->hist_size;
+    ads8688_unlock(dev);
+    if (hist_size == 0 || dev->hist_addr == 0)
+        return -2;
+
+    // check if sample_rate is valid
+    if (sample_rate <= 0)
+        return -2;
+
+    // check if ch is scanned by the core, the aux channel follows the regular ones
+    if (ch >= (uint32_t)(dev->ch_num.num + dev->ch_num.aux))
+        return -2;
+
+    ads8688_lock(dev);
+    ads8688_write_automode(dev, 0);
+
+    dev->hist_ch = ch;
+    reg_write32(dev->base_addr + offsetof(ads8688_ctrl_t, hist_ch), &dev->hist_ch);
+    dev->hist_limit = limit;
+    reg_write32(dev->base_addr + offsetof(ads8688_ctrl_t, hist_limit), &dev->hist_limit);
+
+    // clear all bins
+    dev->hist_ctrl.all = 0;
+    dev->hist_ctrl.clear = 1;
+    reg_write32(dev->base_addr + offsetof(ads8688_ctrl_t, hist_ctrl), &dev->hist_ctrl.all);
+    ads8688_unlock(dev);
+
+    // clearing takes one clock per bin
+    uint32_t poll = 0;
+    bool busy;
+    do
+    {
+        ads8688_lock(dev);
+        reg_read32(dev->base_addr + offsetof(ads8688_ctrl_t, status), &dev->status.all);
+        busy = dev->status.hist_busy;
+        ads8688_unlock(dev);
+
+        if (++poll > ADS8688_HIST_CLEAR_POLL)
+            return -5;
+
+    } while (busy);
+
+    ads8688_lock(dev);
+    dev->hist_ctrl.all = 0;
+    dev->hist_ctrl.run = 1;
+    reg_write32(dev->base_addr + offsetof(ads8688_ctrl_t, hist_ctrl), &dev->hist_ctrl.all);
+    ads8688_unlock(dev);
+
+    // start auto scan
+    return ads8688_set_sample_rate(dev, sample_rate);
+}
+
+/**
+ * @brief ads8688_hist_check    直方图统计监测
+ * @param *dev                  ADC 句柄
+ * @return                      0:完成, 1:统计中
+ */
+int ads8688_hist_check(ads8688_ctrl_t *dev)
+{
+    if (dev == NULL)
+        return -1;
+
+    ads8688_lock(dev);
+    reg_read32(dev->base_addr + offsetof(ads8688_ctrl_t, hist_cnt), &dev->hist_cnt);
+    if ((dev->hist_limit == 0) || (dev->hist_cnt < dev->hist_limit))
+    {
+        ads8688_unlock(dev);
+        return 1;
+    }
+
+    ads8688_write_automode(dev, 0);
+
+    dev->hist_ctrl.all = 0;
+    reg_write32(dev->base_addr + offsetof(ads8688_ctrl_t, hist_ctrl), &dev->hist_ctrl.all);
+    ads8688_unlock(dev);
+
+    return 0;
+}
+
+/***************************************************************************
+ * @brief read the histogram bins
+ *
+ * @param dev           - The device structure.
+ * @param bins          - Destination of the bins.
+ * @param num           - Number of bins to read, from bin 0.
+ *
+ * @return 0 for success or negative error code.
+ *******************************************************************************/
+int ads8688_hist_read(ads8688_ctrl_t *dev, uint32_t *bins, uint32_t num)
+{
+    // check if dev is valid
+    if (dev == NULL || bins == NULL)
+        return -1;
+
+    // check if num is valid
+    if (dev->hist_size == 0 || num > dev->hist_size)
+        return -2;
+
+    for (uint32_t i = 0; i < num; i++)
+    {
+        reg_read32(dev->hist_addr + i * sizeof(uint32_t), &bins[i]);
+    }
+
+    return 0;
+}
+
+/***************************************************************************
+ * @brief set the statistics window, results are updated every window
+ *
+ * @param dev           - The device structure.
+ * @param window        - Window length in scans, 0 to disable statistics.
+ *
+ * @return 0 for success or negative error code.
+ *******************************************************************************/
+int ads8688_stat_start(ads8688_ctrl_t *dev, uint32_t window)
+{
+    // check if dev is valid
+    if (dev == NULL)
+        return -1;
+
+    ads8688_lock(dev);
+    dev->stat_window = window;
+    reg_write32(dev->base_addr + offsetof(ads8688_ctrl_t, stat_window), &dev->stat_window);
+    reg_read32(dev->base_addr + offsetof(ads8688_ctrl_t, stat_window), &dev->stat_window);
+    ads8688_unlock(dev);
+
+    return 0;
+}
+
+/***************************************************************************
+ * @brief read the result of the last completed window of one channel, mean is
+ *  in raw codes and rms is the ac rms sqrt(sumsq / n - mean^2), i.e. the noise
+ *
+ * @param dev           - The device structure.
+ * @param ch            - Channel index.
+ * @param stat          - Destination of the result.
+ *
+ * @return 0 for success, 1 if no window has completed yet or negative error code.
+ *******************************************************************************/
+int ads8688_stat_read(ads8688_ctrl_t *dev, uint32_t ch, ads8688_stat_t *stat)
+{
+    // check if dev is valid
+    if (dev == NULL || stat == NULL)
+        return -1;
+
+    // check if ch is scanned by the core, the aux channel follows the regular ones
+    if (ch >= (uint32_t)(dev->ch_num.num + dev->ch_num.aux))
+        return -2;
+
+    uint32_t addr = dev->base_addr + ADS8688_STAT_BASE + ch * ADS8688_STAT_STRIDE;
+    uint32_t seq = 0;
+    uint32_t val[5];
+
+    ads8688_lock(dev);
+
+    uint32_t window = dev->stat_window;
+    if (window == 0)
+    {
+        ads8688_unlock(dev);
+        return -2;
+    }
+
+    // the result may be replaced while reading, retry until the sequence is stable
+    do
+    {
+        reg_read32(dev->base_addr + offsetof(ads8688_ctrl_t, stat_seq), &dev->stat_seq);
+        for (uint32_t i = 0; i < 5; i++)
+        {
+            reg_read32(addr + i * sizeof(uint32_t), &val[i]);
+        }
+        reg_read32(dev->base_addr + offsetof(ads8688_ctrl_t, stat_seq), &seq);
+    } while (seq != dev->stat_seq);
+
+    ads8688_unlock(dev);
+
+    if (seq == 0)
+        return 1;
+
+    stat->min = (uint16_t)val[0];
+    stat->max = (uint16_t)(val[0] >> 16);
+    stat->sum = ((uint64_t)val[2] << 32) | val[1];
+    stat->sumsq = ((uint64_t)val[4] << 32) | val[3];
+    stat->count = window;
+    stat->seq = seq;
+    stat->mean = (double)stat->sum / stat->count;
+
+    // codes of bipolar ranges are offset binary, the rms of raw codes would be
+    // mostly the offset, so report the ac rms around the mean
+    double var = (double)stat->sumsq / stat->count - stat->mean * stat->mean;
+    stat->rms = sqrt(var > 0 ? var : 0);
+
+    return 0;
+}
+
+/***************************************************************************
+ * @brief start a spi transfer and return at once, finish it with
+ *  ads8688_spi_complete. only one transfer can be in flight per device.
+ *
+ * @param dev       - The device structure.
+ * @param spi_addr  - The spi command byte.
+ * @param spi_wdata - The data to be written.
+ * @param ticket    - Identifies the transfer to ads8688_spi_complete.
+ *
+ * @return 0 for success, -3 when the spi engine is busy, or negative error code.
+ *******************************************************************************/
+int ads8688_spi_submit(ads8688_ctrl_t *dev, uint8_t spi_addr, uint16_t spi_wdata, uint32_t *ticket)
+{
+    // check if dev and ticket are valid
+    if (dev == NULL || ticket == NULL)
+        return -1;
+
+    ads8688_lock(dev);
+
+    // check if spi is busy
+    reg_read32(dev->base_addr + offsetof(ads8688_ctrl_t, status), &dev->status.all);
+    if (dev->spi_pending || dev->status.spi_busy)
+    {
+        ads8688_unlock(dev);
+        return -3;
+    }
+
+    // set addr and write data
+    dev->addr = spi_addr;
+    dev->wr_data = spi_wdata;
+    reg_write32(dev->base_addr + offsetof(ads8688_ctrl_t, addr), &dev->addr);
+    reg_write32(dev->base_addr + offsetof(ads8688_ctrl_t, wr_data), &dev->wr_data);
 
     // mark spi start bit as 1 then write ctrl reg to start spi
+    reg_read32(dev->base_addr + offsetof(ads8688_ctrl_t, ctrl), &dev->ctrl.all);
     dev->ctrl.cfg_spi_start = 1;
     reg_write32(dev->base_addr + offsetof(ads8688_ctrl_t, ctrl), &dev->ctrl.all);
 
-    // wait until spi is done, this step may not be nessary for pc
-    do
+    // 0 is never handed out so a cleared ticket matches no transfer
+    if (++dev->spi_ticket == 0)
+        dev->spi_ticket = 1;
+
+    *ticket = dev->spi_ticket;
+    dev->spi_pending = true;
+    ads8688_unlock(dev);
+
+    return 0;
+}
+
+/***************************************************************************
+ * @brief poll the transfer started by ads8688_spi_submit.
+ *
+ * @param dev       - The device structure.
+ * @param ticket    - The ticket returned by ads8688_spi_submit.
+ * @param spi_rdata - The data read back, may be NULL.
+ *
+ * @return 0 when done, 1 while still running, -2 when the ticket is not the
+ *  transfer in flight, or negative error code.
+ *******************************************************************************/
+int ads8688_spi_complete(ads8688_ctrl_t *dev, uint32_t ticket, uint16_t *spi_rdata)
+{
+    // check if dev is valid
+    if (dev == NULL)
+        return -1;
+
+    ads8688_lock(dev);
+
+    // only the submitter of the transfer in flight may complete it
+    if (!dev->spi_pending || ticket != dev->spi_ticket)
     {
-        reg_read32(dev->base_addr + offsetof(ads8688_ctrl_t, status), &dev->status.all);
+        ads8688_unlock(dev);
+        return -2;
+    }
 
-        // !todo: time out check
-        // if (timeout)
-        //    return -4;
+    reg_read32(dev->base_addr + offsetof(ads8688_ctrl_t, status), &dev->status.all);
+    if (dev->status.spi_busy)
+    {
+        ads8688_unlock(dev);
+        return 1;
+    }
 
-    } while (dev->status.spi_busy);
+    dev->spi_pending = false;
 
     if (!dev->status.spi_done)
+    {
+        ads8688_unlock(dev);
         return -5;
+    }
 
-    // printf("[I]: addr:%2x, wdata:%2x\r\n", spi_addr, spi_wdata);
     // takeout spi read data
     if (spi_rdata)
     {
         reg_read32(dev->base_addr + offsetof(ads8688_ctrl_t, rd_data), &dev->rd_data);
         *spi_rdata = (uint16_t)(dev->rd_data);
-        // printf("[I]: addr:%2x, rdata:%x\r\n", spi_addr, dev->rd_data);
     }
 
+    ads8688_unlock(dev);
+
     return 0;
 }
 
+/***************************************************************************
+ * @brief Writes data into a register.
+ *
+ * @param dev      - The device structure.
+ * @param spi_addr - The address of the register to be written.
+ * @param spi_data  - The value to be written into the register.
+ *
+ * @return Returns 0 in case of success or negative error code.
+ *******************************************************************************/
+int ads8688_spi_transfer(ads8688_ctrl_t *dev, uint8_t spi_addr, uint16_t spi_wdata, uint16_t *spi_rdata)
+{
+    // check if dev is valid
+    if (dev == NULL)
+        return -1;
+
+    // wait for a transfer of another thread to be completed
+    uint32_t ticket;
+    int ret;
+    do
+    {
+        ret = ads8688_spi_submit(dev, spi_addr, spi_wdata, &ticket);
+
+        // !todo: time out check
+    } while (ret == -3);
+
+    if (ret)
+        return ret;
+
+    // wait until spi is done, this step may not be nessary for pc
+    do
+    {
+        ret = ads8688_spi_complete(dev, ticket, spi_rdata);
+
+        // !todo: time out check
+    } while (ret == 1);
+
+    return ret;
+}
+
 int ads8688_spi_write_read(void *dev, uint8_t *tx_buf, uint8_t *rx_buf, uint32_t len)
 {
     // check if dev is valid
@@ -346,17 +1000,60 @@ int ads8688_set_spi_div(ads8688_ctrl_t *dev, int div)
         return -1;
 
     // check if div is valid
-    if (div > FPGA_CLK_FREQ || div <= 0)
+    if (div > (int)ADS8688_MAX_BAUD_DIV || div <= 0)
         return -2;
 
-    div = (div < 4) ? 4 : div;
+    // spi_master needs at least two clocks per sclk period
+    div = (div < 2) ? 2 : div;
 
+    ads8688_lock(dev);
     dev->baud_div = div;
     reg_write32(dev->base_addr + offsetof(ads8688_ctrl_t, baud_div), &dev->baud_div);
 
     reg_read32(dev->base_addr + offsetof(ads8688_ctrl_t, ctrl), &dev->ctrl.all);
     dev->ctrl.baud_load = 1;
     reg_write32(dev->base_addr + offsetof(ads8688_ctrl_t, ctrl), &dev->ctrl.all);
+    ads8688_unlock(dev);
+
+    return 0;
+}
+
+/***************************************************************************
+ * @brief set sclk phase and miso capture delay
+ *
+ * @param dev           - The device structure.
+ * @param phase         - Clocks from the capture edge to the launch edge,
+ *  0 for a symmetric sclk.
+ * @param miso_delay    - Clocks to delay miso capture by.
+ *
+ * @return 0 for success or negative error code.
+ *******************************************************************************/
+int ads8688_set_spi_timing(ads8688_ctrl_t *dev, uint32_t phase, uint32_t miso_delay)
+{
+    if (dev == NULL)
+        return -1;
+
+    // check if timing is valid
+    if (miso_delay > ADS8688_MISO_DELAY_MAX)
+        return -2;
+
+    ads8688_lock(dev);
+    reg_read32(dev->base_addr + offsetof(ads8688_ctrl_t, baud_div), &dev->baud_div);
+    if (phase >= dev->baud_div)
+    {
+        ads8688_unlock(dev);
+        return -2;
+    }
+
+    dev->baud_phase = phase;
+    dev->miso_delay = miso_delay;
+    reg_write32(dev->base_addr + offsetof(ads8688_ctrl_t, baud_phase), &dev->baud_phase);
+    reg_write32(dev->base_addr + offsetof(ads8688_ctrl_t, miso_delay), &dev->miso_delay);
+
+    reg_read32(dev->base_addr + offsetof(ads8688_ctrl_t, ctrl), &dev->ctrl.all);
+    dev->ctrl.baud_load = 1;
+    reg_write32(dev->base_addr + offsetof(ads8688_ctrl_t, ctrl), &dev->ctrl.all);
+    ads8688_unlock(dev);
 
     return 0;
 }
@@ -366,14 +1063,35 @@ int ads8688_spi_init(ads8688_ctrl_t **desc, int id)
     if (desc == NULL)
         return -1;
 
+    if (id < 0 || id >= ADS8688_MAX_DEV_NUM)
+        return -2;
+
     ads8688_ctrl_t *ads8688_ctrl = (ads8688_ctrl_t *)calloc(1, sizeof(ads8688_ctrl_t));
+    if (ads8688_ctrl == NULL)
+        return -1;
+
+    atomic_flag_clear(&ads8688_ctrl->lock);
+    ads8688_ctrl->spi_pending = false;
 
     ads8688_ctrl->base_addr = adc_baseaddr[id];
+    ads8688_ctrl->buf_addr = adc_bufaddr[id];
+    ads8688_ctrl->hist_addr = adc_histaddr[id];
     ads8688_ctrl->max_sample_num = 65536;
 
     // soft reset
     if (ads8688_soft_rst(ads8688_ctrl))
+    {
+        free(ads8688_ctrl);
         return -3;
+    }
+
+    // channels built into the core
+    reg_read32(ads8688_ctrl->base_addr + offsetof(ads8688_ctrl_t, ch_num), &ads8688_ctrl->ch_num.all);
+    if (ads8688_ctrl->ch_num.num == 0 || ads8688_ctrl->ch_num.num > ADS8688_MAX_CH_NUM)
+    {
+        free(ads8688_ctrl);
+        return -4;
+    }
 
     *desc = ads8688_ctrl;
 
@@ -33,6 +33,7 @@
 /************************ Include Files ***************************************/
 /******************************************************************************/
 
+#include <stdatomic.h>
 #include <stdbool.h>
 #include <stdint.h>
 
@@ -41,6 +42,19 @@
 /******************************************************************************/
 #define FPGA_CLK_FREQ 120E6f
 
+#define ADS8688_MAX_DEV_NUM 4 // ads8684_wrapper instances
+
+#define ADS8688_STAT_BASE 0x100U  // per channel statistics
+#define ADS8688_STAT_STRIDE 0x20U // bytes per channel
+
+#define ADS8688_FRAME_BITS 33U // sclk periods per spi frame, including cs setup
+#define ADS8688_FRAME_GAP 4U   // clocks between two frames
+
+#define ADS8688_MISO_DELAY_MAX 15U // clocks
+#define ADS8688_MAX_BAUD_DIV 0xFFFFU // spi_master BAUD_WIDTH = 16
+
+#define ADS8688_HIST_CLEAR_POLL 0x100000U // status polls before a bin clear times out
+
 /******************************************************************************/
 /************************ Types Definitions ***********************************/
 /******************************************************************************/
@@ -55,7 +69,11 @@ typedef union ads8688_ctrl_status_t
         uint32_t sample_busy : 1; // bit 4
         uint32_t sample_err : 1;  // bit 5
         uint32_t sample_done : 1; // bit 6
-        uint32_t : 25;            // bit 7:31
+        uint32_t : 1;             // bit 7
+        uint32_t hist_busy : 1;   // bit 8
+        uint32_t hist_done : 1;   // bit 9
+        uint32_t stat_done : 1;   // bit 10
+        uint32_t : 21;            // bit 11:31
     };
     uint32_t all;
 } ads8688_ctrl_status_t;
@@ -71,12 +89,74 @@ typedef union ads8688_ctrl_ctrl_t
         uint32_t adc_refsel : 1;    // bit 9, RW
         uint32_t cfg_auto_mode : 1; // bit 10, RW
         uint32_t baud_load : 1;     // bit 11, RW
-        uint32_t : 19;              // bit 12:30
+        uint32_t aux_en : 1;        // bit 12, RW
+        uint32_t : 18;              // bit 13:30
         uint32_t soft_rst : 1;      // bit 31, RW, auto clr
     };
     uint32_t all;
 } ads8688_ctrl_ctrl_t;
 
+typedef union ads8688_ctrl_ch_num_t
+{
+    struct
+    {
+        uint32_t num : 8; // bit 0:7, regular channels
+        uint32_t aux : 1; // bit 8, aux channel can be scanned
+        uint32_t : 23;    // bit 9:31
+    };
+    uint32_t all;
+} ads8688_ctrl_ch_num_t;
+
+typedef union ads8688_ctrl_buf_ctrl_t
+{
+    struct
+    {
+        uint32_t enable : 1;  // bit 0, RW
+        uint32_t : 3;         // bit 1:3
+        uint32_t release : 2; // bit 4:5, RW, auto clr
+        uint32_t : 26;        // bit 6:31
+    };
+    uint32_t all;
+} ads8688_ctrl_buf_ctrl_t;
+
+typedef union ads8688_ctrl_buf_state_t
+{
+    struct
+    {
+        uint32_t full : 2;     // bit 0:1
+        uint32_t : 2;          // bit 2:3
+        uint32_t wr_bank : 1;  // bit 4
+        uint32_t : 3;          // bit 5:7
+        uint32_t overflow : 1; // bit 8, W1C
+        uint32_t : 23;         // bit 9:31
+    };
+    uint32_t all;
+} ads8688_ctrl_buf_state_t;
+
+typedef union ads8688_ctrl_hist_ctrl_t
+{
+    struct
+    {
+        uint32_t run : 1;   // bit 0, RW
+        uint32_t : 3;       // bit 1:3
+        uint32_t clear : 1; // bit 4, RW, auto clr
+        uint32_t : 27;      // bit 5:31
+    };
+    uint32_t all;
+} ads8688_ctrl_hist_ctrl_t;
+
+typedef struct ads8688_stat_t
+{
+    uint16_t min;
+    uint16_t max;
+    uint64_t sum;
+    uint64_t sumsq;
+    uint32_t count; // scans in window
+    uint32_t seq;   // window sequence number
+    double mean;    // raw codes
+    double rms;     // ac rms around mean, raw codes
+} ads8688_stat_t;
+
 typedef struct ads8688_ctrl_t
 {
     ads8688_ctrl_ctrl_t ctrl;     // 0x00000000U , RW
@@ -89,8 +169,30 @@ typedef struct ads8688_ctrl_t
     uint32_t sample_num;          // 0x0000001CU , RW
     uint32_t sample_cnt;          // 0x00000020U , RO
     uint32_t baud_div;            // 0x00000024U , RW
+    ads8688_ctrl_buf_ctrl_t buf_ctrl;   // 0x00000028U , RW
+    ads8688_ctrl_buf_state_t buf_state; // 0x0000002CU , RW
+    uint32_t buf_fill;                  // 0x00000030U , RO
+    uint32_t buf_wrap;                  // 0x00000034U , RO
+    uint32_t buf_size;                  // 0x00000038U , RO
+    ads8688_ctrl_hist_ctrl_t hist_ctrl; // 0x0000003CU , RW
+    uint32_t hist_ch;                   // 0x00000040U , RW
+    uint32_t hist_limit;                // 0x00000044U , RW
+    uint32_t hist_cnt;                  // 0x00000048U , RO
+    uint32_t hist_size;                 // 0x0000004CU , RO
+    uint32_t stat_window;               // 0x00000050U , RW
+    uint32_t stat_seq;                  // 0x00000054U , RO
+    ads8688_ctrl_ch_num_t ch_num;       // 0x00000058U , RO
+    uint32_t scan_frac;                 // 0x0000005CU , RW
+    uint32_t baud_phase;                // 0x00000060U , RW
+    uint32_t miso_delay;                // 0x00000064U , RW
     uint32_t base_addr;
+    uint32_t buf_addr;
+    uint32_t hist_addr;
+    uint32_t buf_rd_bank;
     uint32_t max_sample_num;
+    atomic_flag lock; // guards ctrl and the spi engine
+    bool spi_pending; // a submitted spi transfer is not completed yet
+    uint32_t spi_ticket; // ticket of the last submitted spi transfer
 } ads8688_ctrl_t;
 
 /******************************************************************************/
@@ -99,9 +201,29 @@ typedef struct ads8688_ctrl_t
 
 extern int ads8688_start_sample(ads8688_ctrl_t *dev, uint32_t sample_num, uint32_t sample_rate);
 extern int ads8688_sample_check(ads8688_ctrl_t *dev);
+extern int ads8688_set_sample_rate(ads8688_ctrl_t *dev, double sample_rate);
+extern int ads8688_get_sample_rate(ads8688_ctrl_t *dev, double *sample_rate);
+
+extern int ads8688_buf_start(ads8688_ctrl_t *dev, double sample_rate);
+extern int ads8688_buf_stop(ads8688_ctrl_t *dev);
+extern int ads8688_buf_read(ads8688_ctrl_t *dev, void *buf, uint32_t size, uint32_t *wrap);
+
+extern int ads8688_hist_start(ads8688_ctrl_t *dev, uint32_t ch, uint32_t limit, double sample_rate);
+extern int ads8688_hist_check(ads8688_ctrl_t *dev);
+extern int ads8688_hist_read(ads8688_ctrl_t *dev, uint32_t *bins, uint32_t num);
+
+extern int ads8688_stat_start(ads8688_ctrl_t *dev, uint32_t window);
+extern int ads8688_stat_read(ads8688_ctrl_t *dev, uint32_t ch, ads8688_stat_t *stat);
+
+extern int ads8688_get_automode(ads8688_ctrl_t *dev, bool *en);
+extern int ads8688_set_aux_en(ads8688_ctrl_t *dev, bool en);
 
 extern int ads8688_set_spi_div(ads8688_ctrl_t *dev, int div);
+extern int ads8688_set_spi_timing(ads8688_ctrl_t *dev, uint32_t phase, uint32_t miso_delay);
 extern int ads8688_spi_init(ads8688_ctrl_t **desc, int id);
+extern int ads8688_spi_submit(ads8688_ctrl_t *dev, uint8_t spi_addr, uint16_t spi_wdata, uint32_t *ticket);
+extern int ads8688_spi_complete(ads8688_ctrl_t *dev, uint32_t ticket, uint16_t *spi_rdata);
+extern int ads8688_spi_transfer(ads8688_ctrl_t *dev, uint8_t spi_addr, uint16_t spi_wdata, uint16_t *spi_rdata);
 extern int ads8688_spi_write_read(void *dev, uint8_t *tx_buf, uint8_t *rx_buf, uint32_t len);
 
 /******************************************************************************/
@@ -42,6 +42,8 @@ module ads8684_conf_wrapper (
 
     input wire        baud_load,
     input wire [31:0] baud_div,
+    input wire [31:0] baud_phase,
+    input wire [ 3:0] miso_delay,
 
     input  wire [ 7:0] cfg_addr,       // SPI操作地址
     input  wire [ 7:0] cfg_wr_data,    // SPI写数据
@@ -89,21 +91,23 @@ module ads8684_conf_wrapper (
         .CPHA      (1'b1),
         .MSB       (1'b1)
     ) spi_master_inst (
-        .clk     (clk),
-        .rst     (rst),
-        .load    (baud_load),
-        .baud_div(baud_div),
-        .spi_scsn(spi_scsn),
-        .spi_sclk(spi_sclk),
-        .spi_miso(spi_miso),
-        .spi_mosi(spi_mosi),
-        .tx_busy (tx_busy),
-        .tx_valid(tx_valid),
-        .tx_data (tx_data),
-        .tx_ready(tx_ready),
-        .rx_data (rx_data),
-        .rx_valid(rx_valid),
-        .tx_done ()
+        .clk       (clk),
+        .rst       (rst),
+        .load      (baud_load),
+        .baud_div  (baud_div),
+        .baud_phase(baud_phase),
+        .miso_delay(miso_delay),
+        .spi_scsn  (spi_scsn),
+        .spi_sclk  (spi_sclk),
+        .spi_miso  (spi_miso),
+        .spi_mosi  (spi_mosi),
+        .tx_busy   (tx_busy),
+        .tx_valid  (tx_valid),
+        .tx_data   (tx_data),
+        .tx_ready  (tx_ready),
+        .rx_data   (rx_data),
+        .rx_valid  (rx_valid),
+        .tx_done   ()
     );
 endmodule
 
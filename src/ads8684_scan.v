@@ -37,15 +37,17 @@
 // verilog_format: on
 
 module ads8684_scan #(
-    parameter integer CHANNEL_NUM = 8
+    parameter integer CHANNEL_NUM = 8,
+    parameter integer AUX_ENABLE  = 0,
+    parameter integer SCAN_NUM    = CHANNEL_NUM + AUX_ENABLE
 ) (
     input wire clk,
     input wire rst,
 
-    input  wire       scan_req,
-    input  wire [7:0] cfg_ch_enable,
-    input  wire       cfg_auto_mode,
-    output reg        sts_busy,
+    input  wire                  scan_req,
+    input  wire [(SCAN_NUM-1):0] cfg_ch_enable,  // 通道使能, 最高位为 AUX 通道 (AUX_ENABLE=1)
+    input  wire                  cfg_auto_mode,
+    output reg                   sts_busy,
 
     input  wire        tx_busy,
     input  wire        tx_ready,
@@ -54,10 +56,16 @@ module ads8684_scan #(
     input  wire        rx_valid,
     input  wire [31:0] rx_data,
 
-    output wire [(CHANNEL_NUM*16-1):0] m_tdata,
-    output reg                         m_tvalid
+    output wire [(SCAN_NUM*16-1):0] m_tdata,
+    output reg                      m_tvalid
 );
 
+    localparam integer INDEX_WIDTH = (SCAN_NUM > 1) ? $clog2(SCAN_NUM) : 1;
+
+    localparam [31:0] CMD_NO_OP = 32'h00000000;
+    localparam [31:0] CMD_AUTO_RST = 32'hA0000000;
+    localparam [31:0] CMD_MAN_AUX = 32'hE0000000;
+
     localparam FSM_IDLE = 8'd0;
     localparam FSM_CMD = 8'd1;
     localparam FSM_CMD_WAIT = 8'd2;
@@ -69,15 +77,23 @@ module ads8684_scan #(
     reg [7:0] nstate = FSM_IDLE;
 
     genvar ii;
-    reg         auto_scan_en = 1'b0;
-    reg  [15:0] rx_data_reg         [0:(CHANNEL_NUM-1)];
-    reg  [ 2:0] current_index;
-    reg  [ 7:0] current_bin;
-    wire [ 2:0] next_index;
-    wire [ 7:0] next_bin;
-    wire        roll_over;
+    integer jj;
+    reg                      auto_scan_en = 1'b0;
+    reg  [             15:0] rx_data_reg         [0:(SCAN_NUM-1)];
+    reg  [(INDEX_WIDTH-1):0] current_index;
+    reg  [   (SCAN_NUM-1):0] current_bin;
+    wire [(INDEX_WIDTH-1):0] next_index;
+    wire [   (SCAN_NUM-1):0] next_bin;
+    wire                     roll_over;
+    wire                     ch_any;
+    wire                     aux_en;
+    reg  [(INDEX_WIDTH-1):0] last_ch;
 
-    reg  [31:0] scan_stack;
+    reg  [              7:0] scan_stack;
+
+    // at least one regular channel is needed to run the device sequence
+    assign ch_any = |cfg_ch_enable[(CHANNEL_NUM-1):0];
+    assign aux_en = (AUX_ENABLE != 0) & cfg_ch_enable[SCAN_NUM-1];
 
     always @(posedge clk) begin
         if (rst) begin
@@ -132,7 +148,7 @@ module ads8684_scan #(
         end else begin
             case (cstate)
                 FSM_IDLE: begin
-                    if (auto_scan_en & (|cfg_ch_enable) & ~tx_busy) begin
+                    if (auto_scan_en & ch_any & ~tx_busy) begin
                         nstate = FSM_CMD;
                     end else begin
                         nstate = FSM_IDLE;
@@ -162,7 +178,7 @@ module ads8684_scan #(
                 FSM_WAIT: begin
                     if (!tx_busy) begin
                         if (roll_over) begin
-                            if (auto_scan_en & (|cfg_ch_enable)) begin
+                            if (auto_scan_en & ch_any) begin
                                 nstate = FSM_DIN;
                             end else begin
                                 nstate = FSM_END;
@@ -190,11 +206,19 @@ module ads8684_scan #(
         end else begin
             case (nstate)
                 FSM_CMD: begin
-                    tx_data  <= 32'hA0000000;
+                    tx_data  <= CMD_AUTO_RST;
                     tx_valid <= 1'b1;
                 end
                 FSM_DIN: begin
-                    tx_data  <= 0;
+                    // next_index is the channel read out in this frame, the command
+                    // selects the channel read out in the following frame
+                    if (aux_en && (next_index == last_ch)) begin
+                        tx_data <= CMD_MAN_AUX;
+                    end else if (aux_en && (next_index == SCAN_NUM - 1)) begin
+                        tx_data <= CMD_AUTO_RST;
+                    end else begin
+                        tx_data <= CMD_NO_OP;
+                    end
                     tx_valid <= 1'b1;
                 end
                 default: begin
@@ -210,7 +234,7 @@ module ads8684_scan #(
     // *******************************************************************************
 
     generate
-        for (ii = 0; ii < CHANNEL_NUM; ii = ii + 1) begin
+        for (ii = 0; ii < SCAN_NUM; ii = ii + 1) begin
             always @(posedge clk) begin
                 if (rst) begin
                     rx_data_reg[ii] <= 16'h0000;
@@ -261,8 +285,8 @@ module ads8684_scan #(
     // *******************************************************************************
     round_arb #(
         .SCAN_DIR   (1'b0),
-        .CHANNEL_NUM(8),
-        .INDEX_WIDTH(3)
+        .CHANNEL_NUM(SCAN_NUM),
+        .INDEX_WIDTH(INDEX_WIDTH)
     ) round_arb_inst (
         .clk          (clk),
         .rst          (rst),
@@ -273,15 +297,28 @@ module ads8684_scan #(
         .next_bin     (next_bin)
     );
 
+    // last enabled regular channel, followed by the aux channel when enabled
+    always @(posedge clk) begin
+        if (rst) begin
+            last_ch <= 0;
+        end else begin
+            for (jj = 0; jj < CHANNEL_NUM; jj = jj + 1) begin
+                if (cfg_ch_enable[jj]) begin
+                    last_ch <= jj;
+                end
+            end
+        end
+    end
+
     always @(posedge clk) begin
         if (rst) begin
-            current_index <= 7;
-            current_bin   <= 8'h80;
+            current_index <= SCAN_NUM - 1;
+            current_bin   <= 1'b1 << (SCAN_NUM - 1);
         end else begin
             case (cstate)
                 FSM_IDLE: begin
-                    current_index <= 7;
-                    current_bin   <= 8'h80;
+                    current_index <= SCAN_NUM - 1;
+                    current_bin   <= 1'b1 << (SCAN_NUM - 1);
                 end
                 FSM_DIN: begin
                     if (tx_valid & tx_ready) begin
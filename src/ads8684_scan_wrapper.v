@@ -37,16 +37,20 @@
 // verilog_format: on
 
 module ads8684_scan_wrapper #(
-    parameter integer CHANNEL_NUM = 8
+    parameter integer CHANNEL_NUM = 8,
+    parameter integer AUX_ENABLE  = 0,
+    parameter integer SCAN_NUM    = CHANNEL_NUM + AUX_ENABLE
 ) (
     input wire clk,
     input wire rst,
 
     input wire        baud_load,
     input wire [31:0] baud_div,
+    input wire [31:0] baud_phase,
+    input wire [ 3:0] miso_delay,
 
-    input wire [7:0] cfg_ch_enable,  // SPI 传输繁忙
-    input wire       cfg_auto_mode,  // 自动采样使能
+    input wire [(SCAN_NUM-1):0] cfg_ch_enable,  // 通道使能, 最高位为 AUX 通道 (AUX_ENABLE=1)
+    input wire                  cfg_auto_mode,  // 自动采样使能
 
 
     output wire sts_spi_busy,  // SPI 传输繁忙
@@ -57,8 +61,8 @@ module ads8684_scan_wrapper #(
     output wire spi_mosi,  // SPI串行输出
     input  wire spi_miso,  // SPI串行输入
 
-    output wire [CHANNEL_NUM*16-1:0] m_tdata,  // adc数据
-    output wire                      m_tvalid  // adc数据有效
+    output wire [SCAN_NUM*16-1:0] m_tdata,  // adc数据
+    output wire                   m_tvalid  // adc数据有效
 );
 
     wire        tx_busy;
@@ -69,7 +73,8 @@ module ads8684_scan_wrapper #(
     wire [31:0] rx_data;
 
     ads8684_scan #(
-        .CHANNEL_NUM(CHANNEL_NUM)
+        .CHANNEL_NUM(CHANNEL_NUM),
+        .AUX_ENABLE (AUX_ENABLE)
     ) ads8684_scan_inst (
         .clk          (clk),
         .rst         (rst),
@@ -92,21 +97,23 @@ module ads8684_scan_wrapper #(
         .CPHA      (1'b1),
         .MSB       (1'b1)
     ) spi_master_inst (
-        .clk     (clk),
-        .rst    (rst),
-        .load    (baud_load),
-        .baud_div(baud_div),
-        .spi_scsn(spi_scsn),
-        .spi_sclk(spi_sclk),
-        .spi_miso(spi_miso),
-        .spi_mosi(spi_mosi),
-        .tx_busy (tx_busy),
-        .tx_ready(tx_ready),
-        .tx_valid(tx_valid),
-        .tx_data (tx_data),
-        .rx_valid(rx_valid),
-        .rx_data (rx_data),
-        .tx_done ()
+        .clk       (clk),
+        .rst       (rst),
+        .load      (baud_load),
+        .baud_div  (baud_div),
+        .baud_phase(baud_phase),
+        .miso_delay(miso_delay),
+        .spi_scsn  (spi_scsn),
+        .spi_sclk  (spi_sclk),
+        .spi_miso  (spi_miso),
+        .spi_mosi  (spi_mosi),
+        .tx_busy   (tx_busy),
+        .tx_ready  (tx_ready),
+        .tx_valid  (tx_valid),
+        .tx_data   (tx_data),
+        .rx_valid  (rx_valid),
+        .rx_data   (rx_data),
+        .tx_done   ()
     );
 endmodule
 
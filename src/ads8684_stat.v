@@ -0,0 +1,188 @@
+// +FHEADER-------------------------------------------------------------------------------
+// Copyright (c) 2024 john_tito All rights reserved.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+// ---------------------------------------------------------------------------------------
+// Author        : john_tito
+// Module Name   : ads8684_stat
+// ---------------------------------------------------------------------------------------
+// Revision      : 1.0
+// Description   : per channel min / max / sum / sum of squares over a window of
+//                 scans, results are held until the next window completes
+// ---------------------------------------------------------------------------------------
+// Synthesizable : Yes
+// Clock Domains : clk
+// Reset Strategy: sync reset
+// -FHEADER-------------------------------------------------------------------------------
+
+// verilog_format: off
+`resetall
+`timescale 1ns / 1ps
+`default_nettype none
+// verilog_format: on
+
+module ads8684_stat #(
+    parameter integer CHANNEL_NUM = 4
+) (
+    input wire clk,
+    input wire rst,
+
+    input  wire [                31:0] cfg_window,  // 统计窗口 (扫描次数), 0: 关闭统计
+    output reg  [(CHANNEL_NUM*16-1):0] sts_min,     // 最小值
+    output reg  [(CHANNEL_NUM*16-1):0] sts_max,     // 最大值
+    output reg  [(CHANNEL_NUM*48-1):0] sts_sum,     // 累加和
+    output reg  [(CHANNEL_NUM*64-1):0] sts_sumsq,   // 平方和
+    output reg  [                31:0] sts_seq,     // 已完成的窗口数
+    output reg                         sts_done,    // 窗口完成
+
+    input wire [(CHANNEL_NUM*16-1):0] s_tdata,
+    input wire                        s_tvalid
+);
+
+    reg  [(CHANNEL_NUM*16-1):0] snap_data;
+    reg                         snap_busy;
+    reg                         snap_first;
+    reg                         snap_last;
+    reg  [                 7:0] snap_idx;
+
+    reg                         upd_en;
+    reg                         upd_last;
+    reg  [                 7:0] upd_idx;
+    reg  [                15:0] upd_code;
+    reg  [                31:0] upd_sq;
+
+    reg  [                31:0] scan_cnt;
+    reg                         copy_en;
+
+    reg  [                15:0] acc_min             [0:(CHANNEL_NUM-1)];
+    reg  [                15:0] acc_max             [0:(CHANNEL_NUM-1)];
+    reg  [                47:0] acc_sum             [0:(CHANNEL_NUM-1)];
+    reg  [                63:0] acc_sumsq           [0:(CHANNEL_NUM-1)];
+
+    integer                     jj;
+
+    // *******************************************************************************
+    // take a snapshot of each scan and walk through the channels one per clock,
+    // scans are far apart so a single multiplier serves all channels
+    // *******************************************************************************
+    always @(posedge clk) begin
+        if (rst) begin
+            snap_data  <= 0;
+            snap_busy  <= 1'b0;
+            snap_first <= 1'b0;
+            snap_last  <= 1'b0;
+            snap_idx   <= 0;
+        end else begin
+            if (s_tvalid && (cfg_window != 0) && ~snap_busy) begin
+                snap_data  <= s_tdata;
+                snap_busy  <= 1'b1;
+                snap_first <= (scan_cnt == 0);
+                snap_last  <= (scan_cnt >= cfg_window - 1);
+                snap_idx   <= 0;
+            end else if (snap_busy) begin
+                snap_data <= snap_data >> 16;
+                snap_busy <= (snap_idx != CHANNEL_NUM - 1);
+                snap_idx  <= snap_idx + 1;
+            end
+        end
+    end
+
+    always @(posedge clk) begin
+        if (rst) begin
+            upd_en   <= 1'b0;
+            upd_last <= 1'b0;
+            upd_idx  <= 0;
+            upd_code <= 0;
+            upd_sq   <= 0;
+        end else begin
+            upd_en   <= snap_busy;
+            upd_last <= snap_busy && (snap_idx == CHANNEL_NUM - 1);
+            upd_idx  <= snap_idx;
+            upd_code <= snap_data[15:0];
+            upd_sq   <= snap_data[15:0] * snap_data[15:0];
+        end
+    end
+
+    // *******************************************************************************
+    // accumulate, the first scan of a window reloads the accumulators
+    // *******************************************************************************
+    always @(posedge clk) begin
+        if (upd_en) begin
+            if (snap_first) begin
+                acc_min[upd_idx]   <= upd_code;
+                acc_max[upd_idx]   <= upd_code;
+                acc_sum[upd_idx]   <= upd_code;
+                acc_sumsq[upd_idx] <= upd_sq;
+            end else begin
+                if (upd_code < acc_min[upd_idx]) begin
+                    acc_min[upd_idx] <= upd_code;
+                end
+                if (upd_code > acc_max[upd_idx]) begin
+                    acc_max[upd_idx] <= upd_code;
+                end
+                acc_sum[upd_idx]   <= acc_sum[upd_idx] + upd_code;
+                acc_sumsq[upd_idx] <= acc_sumsq[upd_idx] + upd_sq;
+            end
+        end
+    end
+
+    always @(posedge clk) begin
+        if (rst) begin
+            scan_cnt <= 0;
+            copy_en  <= 1'b0;
+        end else begin
+            if (cfg_window == 0) begin
+                scan_cnt <= 0;
+            end else if (upd_en & upd_last) begin
+                scan_cnt <= snap_last ? 0 : scan_cnt + 1;
+            end
+            copy_en <= upd_en & upd_last & snap_last;
+        end
+    end
+
+    // *******************************************************************************
+    // result buffer
+    // *******************************************************************************
+    always @(posedge clk) begin
+        if (rst) begin
+            sts_min   <= 0;
+            sts_max   <= 0;
+            sts_sum   <= 0;
+            sts_sumsq <= 0;
+            sts_seq   <= 0;
+            sts_done  <= 1'b0;
+        end else begin
+            if (copy_en) begin
+                for (jj = 0; jj < CHANNEL_NUM; jj = jj + 1) begin
+                    sts_min[jj*16+:16]   <= acc_min[jj];
+                    sts_max[jj*16+:16]   <= acc_max[jj];
+                    sts_sum[jj*48+:48]   <= acc_sum[jj];
+                    sts_sumsq[jj*64+:64] <= acc_sumsq[jj];
+                end
+                sts_seq <= sts_seq + 1;
+            end
+            sts_done <= copy_en;
+        end
+    end
+
+endmodule
+
+// verilog_format: off
+`resetall
+// verilog_format: on
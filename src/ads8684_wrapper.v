@@ -37,14 +37,23 @@
 // verilog_format: on
 
 module ads8684_wrapper #(
-    parameter integer C_APB_DATA_WIDTH = 32,
-    parameter integer C_APB_ADDR_WIDTH = 16,
-    parameter integer C_S_BASEADDR     = 0,
-    parameter integer CHANNEL_NUM      = 4
+    parameter integer C_APB_DATA_WIDTH    = 32,
+    parameter integer C_APB_ADDR_WIDTH    = 16,
+    parameter integer C_S_BASEADDR        = 0,
+    parameter integer CHANNEL_NUM         = 4,                 // 常规通道数量, ADS8681:1 ADS8684:4 ADS8688:8
+    parameter integer AUX_ENABLE          = 0,                 // 1: AUX 通道可参与扫描, 位于最高通道之后
+    parameter integer M_TDATA_WIDTH       = (CHANNEL_NUM + AUX_ENABLE) * 16,  // 不小于扫描数据宽度, 多次扫描按字节拼接, 可跨拍
+    parameter integer C_BUF_DEPTH         = 0,                 // 采集缓存每个缓冲区深度 (扫描次数, 2 的整数次幂), 0: 不使用缓存
+    parameter integer C_S_AXI_ADDR_WIDTH  = 16,
+    parameter integer C_S_AXI_DATA_WIDTH  = ((CHANNEL_NUM + AUX_ENABLE) * 16 <= 64) ? 64 :
+                                            ((CHANNEL_NUM + AUX_ENABLE) * 16 <= 128) ? 128 : 256,  // 不小于 (CHANNEL_NUM+AUX_ENABLE)*16
+    parameter integer C_HIST_BIN_WIDTH    = 0,                 // 直方图区间数量 2^C_HIST_BIN_WIDTH, 0: 不使用直方图
+    parameter integer C_S_HIST_ADDR_WIDTH = 18,
+    parameter integer C_STAT_ENABLE       = 0                  // 1: 使用通道统计
 ) (
     //
     (* X_INTERFACE_INFO = "xilinx.com:signal:clock:1.0 clk CLK" *)
-    (* X_INTERFACE_PARAMETER = "ASSOCIATED_BUSIF s_apb:m:spi, ASSOCIATED_RESET rstn" *)
+    (* X_INTERFACE_PARAMETER = "ASSOCIATED_BUSIF s_apb:s_axi:s_hist_axi:m:spi, ASSOCIATED_RESET rstn" *)
     input  wire                          clk,        //  (required)
     //
     (* X_INTERFACE_INFO = "xilinx.com:signal:reset:1.0 rstn RST" *)
@@ -68,6 +77,52 @@ module ads8684_wrapper #(
     (* X_INTERFACE_INFO = "xilinx.com:interface:apb:1.0 s_apb PSLVERR" *)
     output wire                          s_pslverr,  // Slave Error Response (required)
 
+    (* X_INTERFACE_INFO = "xilinx.com:interface:aximm:1.0 s_axi ARADDR" *)
+    input  wire [(C_S_AXI_ADDR_WIDTH-1):0] s_axi_araddr,
+    (* X_INTERFACE_INFO = "xilinx.com:interface:aximm:1.0 s_axi ARLEN" *)
+    input  wire [                     7:0] s_axi_arlen,
+    (* X_INTERFACE_INFO = "xilinx.com:interface:aximm:1.0 s_axi ARSIZE" *)
+    input  wire [                     2:0] s_axi_arsize,
+    (* X_INTERFACE_INFO = "xilinx.com:interface:aximm:1.0 s_axi ARBURST" *)
+    input  wire [                     1:0] s_axi_arburst,
+    (* X_INTERFACE_INFO = "xilinx.com:interface:aximm:1.0 s_axi ARVALID" *)
+    input  wire                            s_axi_arvalid,
+    (* X_INTERFACE_INFO = "xilinx.com:interface:aximm:1.0 s_axi ARREADY" *)
+    output wire                            s_axi_arready,
+    (* X_INTERFACE_INFO = "xilinx.com:interface:aximm:1.0 s_axi RDATA" *)
+    output wire [(C_S_AXI_DATA_WIDTH-1):0] s_axi_rdata,
+    (* X_INTERFACE_INFO = "xilinx.com:interface:aximm:1.0 s_axi RRESP" *)
+    output wire [                     1:0] s_axi_rresp,
+    (* X_INTERFACE_INFO = "xilinx.com:interface:aximm:1.0 s_axi RLAST" *)
+    output wire                            s_axi_rlast,
+    (* X_INTERFACE_INFO = "xilinx.com:interface:aximm:1.0 s_axi RVALID" *)
+    output wire                            s_axi_rvalid,
+    (* X_INTERFACE_INFO = "xilinx.com:interface:aximm:1.0 s_axi RREADY" *)
+    input  wire                            s_axi_rready,
+
+    (* X_INTERFACE_INFO = "xilinx.com:interface:aximm:1.0 s_hist_axi ARADDR" *)
+    input  wire [(C_S_HIST_ADDR_WIDTH-1):0] s_hist_axi_araddr,
+    (* X_INTERFACE_INFO = "xilinx.com:interface:aximm:1.0 s_hist_axi ARLEN" *)
+    input  wire [                      7:0] s_hist_axi_arlen,
+    (* X_INTERFACE_INFO = "xilinx.com:interface:aximm:1.0 s_hist_axi ARSIZE" *)
+    input  wire [                      2:0] s_hist_axi_arsize,
+    (* X_INTERFACE_INFO = "xilinx.com:interface:aximm:1.0 s_hist_axi ARBURST" *)
+    input  wire [                      1:0] s_hist_axi_arburst,
+    (* X_INTERFACE_INFO = "xilinx.com:interface:aximm:1.0 s_hist_axi ARVALID" *)
+    input  wire                             s_hist_axi_arvalid,
+    (* X_INTERFACE_INFO = "xilinx.com:interface:aximm:1.0 s_hist_axi ARREADY" *)
+    output wire                             s_hist_axi_arready,
+    (* X_INTERFACE_INFO = "xilinx.com:interface:aximm:1.0 s_hist_axi RDATA" *)
+    output wire [                     31:0] s_hist_axi_rdata,
+    (* X_INTERFACE_INFO = "xilinx.com:interface:aximm:1.0 s_hist_axi RRESP" *)
+    output wire [                      1:0] s_hist_axi_rresp,
+    (* X_INTERFACE_INFO = "xilinx.com:interface:aximm:1.0 s_hist_axi RLAST" *)
+    output wire                             s_hist_axi_rlast,
+    (* X_INTERFACE_INFO = "xilinx.com:interface:aximm:1.0 s_hist_axi RVALID" *)
+    output wire                             s_hist_axi_rvalid,
+    (* X_INTERFACE_INFO = "xilinx.com:interface:aximm:1.0 s_hist_axi RREADY" *)
+    input  wire                             s_hist_axi_rready,
+
     output wire spi_scsn,  // SPI片选
     output wire spi_sclk,  // SPI时钟
     output wire spi_mosi,  // SPI串行输出
@@ -76,16 +131,19 @@ module ads8684_wrapper #(
     output wire adc_rstn,   // adc芯片复位
     output wire adc_refsel, // adc芯片参考电压选择
 
-    output wire [63:0] m_tdata,
-    output wire [ 7:0] m_tkeep,
-    output wire        m_tvalid,
-    output wire        m_tlast,
-    input  wire        m_tready
+    output wire [  (M_TDATA_WIDTH-1):0] m_tdata,
+    output wire [(M_TDATA_WIDTH/8-1):0] m_tkeep,
+    output wire                         m_tvalid,
+    output wire                         m_tlast,
+    input  wire                         m_tready
 );
 
+    localparam integer SCAN_NUM = CHANNEL_NUM + AUX_ENABLE;
 
     wire                        baud_load;
     wire [                31:0] baud_div;
+    wire [                31:0] baud_phase;
+    wire [                 3:0] miso_delay;
 
     wire [                 7:0] conf_spi_addr;
     wire [                 7:0] conf_spi_wr_data;
@@ -110,9 +168,11 @@ module ads8684_wrapper #(
     wire                        soft_rst;
     wire                        sts_spi_busy;
     wire [                 7:0] cfg_ch_enable;
+    wire                        cfg_aux_enable;
+    wire [      (SCAN_NUM-1):0] scan_ch_enable;
     wire                        cfg_auto_mode;
 
-    wire [(CHANNEL_NUM*16-1):0] adc_tdata;
+    wire [   (SCAN_NUM*16-1):0] adc_tdata;
     wire                        adc_tvalid;
 
     wire                        sample_req;
@@ -122,6 +182,30 @@ module ads8684_wrapper #(
     wire                        sample_err;
     wire                        sample_done;
 
+    wire                        buf_enable;
+    wire [                 1:0] buf_release;
+    wire [                 1:0] buf_full;
+    wire                        buf_wr_bank;
+    wire [                31:0] buf_fill;
+    wire [                31:0] buf_wrap_cnt;
+    wire                        buf_overflow;
+
+    wire                        hist_run;
+    wire                        hist_clear;
+    wire [                 7:0] hist_channel;
+    wire [                31:0] hist_limit;
+    wire                        hist_busy;
+    wire                        hist_done;
+    wire [                31:0] hist_count;
+
+    wire [                31:0] stat_window;
+    wire [   (SCAN_NUM*16-1):0] stat_min;
+    wire [   (SCAN_NUM*16-1):0] stat_max;
+    wire [   (SCAN_NUM*48-1):0] stat_sum;
+    wire [   (SCAN_NUM*64-1):0] stat_sumsq;
+    wire [                31:0] stat_seq;
+    wire                        stat_done;
+
     assign spi_scsn      = (cfg_auto_mode == 1'b0) ? conf_spi_scsn : scan_spi_scsn;
     assign spi_sclk      = (cfg_auto_mode == 1'b0) ? conf_spi_sclk : scan_spi_sclk;
     assign spi_mosi      = (cfg_auto_mode == 1'b0) ? conf_spi_mosi : scan_spi_mosi;
@@ -134,7 +218,11 @@ module ads8684_wrapper #(
     ads8688_ui #(
         .C_APB_DATA_WIDTH(C_APB_DATA_WIDTH),
         .C_APB_ADDR_WIDTH(C_APB_ADDR_WIDTH),
-        .C_S_BASEADDR    (C_S_BASEADDR)
+        .C_S_BASEADDR    (C_S_BASEADDR),
+        .CHANNEL_NUM     (CHANNEL_NUM),
+        .AUX_ENABLE      (AUX_ENABLE),
+        .C_BUF_BANK_SIZE (C_BUF_DEPTH * C_S_AXI_DATA_WIDTH / 8),
+        .C_HIST_BIN_NUM  ((C_HIST_BIN_WIDTH > 0) ? (1 << C_HIST_BIN_WIDTH) : 0)
     ) ads8688_ui_inst (
         .clk            (clk),
         .rstn           (rstn),
@@ -148,12 +236,35 @@ module ads8684_wrapper #(
         .s_pslverr      (s_pslverr),
         .baud_load      (baud_load),
         .baud_div       (baud_div),
+        .baud_phase     (baud_phase),
+        .miso_delay     (miso_delay),
         .sample_req     (sample_req),
         .sample_num     (sample_num),
         .sample_progress(sample_progress),
         .sample_busy    (sample_busy),
         .sample_err     (sample_err),
         .sample_done    (sample_done),
+        .buf_enable     (buf_enable),
+        .buf_release    (buf_release),
+        .buf_full       (buf_full),
+        .buf_wr_bank    (buf_wr_bank),
+        .buf_fill       (buf_fill),
+        .buf_wrap_cnt   (buf_wrap_cnt),
+        .buf_overflow   (buf_overflow),
+        .hist_run       (hist_run),
+        .hist_clear     (hist_clear),
+        .hist_channel   (hist_channel),
+        .hist_limit     (hist_limit),
+        .hist_busy      (hist_busy),
+        .hist_done      (hist_done),
+        .hist_count     (hist_count),
+        .stat_window    (stat_window),
+        .stat_min       (stat_min),
+        .stat_max       (stat_max),
+        .stat_sum       (stat_sum),
+        .stat_sumsq     (stat_sumsq),
+        .stat_seq       (stat_seq),
+        .stat_done      (stat_done),
         .cfg_addr       (conf_spi_addr),
         .cfg_wr_data    (conf_spi_wr_data),
         .cfg_rd_data    (conf_spi_rd_data),
@@ -162,6 +273,7 @@ module ads8684_wrapper #(
         .sts_spi_busy   (sts_spi_busy),
         .cfg_auto_mode  (cfg_auto_mode),
         .cfg_ch_enable  (cfg_ch_enable),
+        .cfg_aux_enable (cfg_aux_enable),
         .sync           (scan_req),
         .soft_rst       (soft_rst),
         .adc_refsel     (adc_refsel),
@@ -173,6 +285,8 @@ module ads8684_wrapper #(
         .rst          (soft_rst),
         .baud_load    (baud_load),
         .baud_div     (baud_div),
+        .baud_phase   (baud_phase),
+        .miso_delay   (miso_delay),
         .cfg_auto_mode(cfg_auto_mode),
         .cfg_ch_enable(cfg_ch_enable),
         .cfg_addr     (conf_spi_addr),
@@ -187,15 +301,27 @@ module ads8684_wrapper #(
         .spi_miso     (conf_spi_miso)
     );
 
+    // aux channel is scanned after the highest regular channel
+    generate
+        if (AUX_ENABLE) begin : gen_aux_enable
+            assign scan_ch_enable = {cfg_aux_enable, cfg_ch_enable[(CHANNEL_NUM-1):0]};
+        end else begin : gen_no_aux_enable
+            assign scan_ch_enable = cfg_ch_enable[(CHANNEL_NUM-1):0];
+        end
+    endgenerate
+
     ads8684_scan_wrapper #(
-        .CHANNEL_NUM(CHANNEL_NUM)
+        .CHANNEL_NUM(CHANNEL_NUM),
+        .AUX_ENABLE (AUX_ENABLE)
     ) ads8684_scan_wrapper_inst (
         .clk          (clk),
         .rst          (soft_rst),
         .baud_load    (baud_load),
         .baud_div     (baud_div),
+        .baud_phase   (baud_phase),
+        .miso_delay   (miso_delay),
         .cfg_auto_mode(cfg_auto_mode),
-        .cfg_ch_enable(cfg_ch_enable),
+        .cfg_ch_enable(scan_ch_enable),
         .sts_spi_busy (scan_spi_busy),
         .sync         (scan_req),
         .spi_scsn     (scan_spi_scsn),
@@ -207,7 +333,8 @@ module ads8684_wrapper #(
     );
 
     sample_core #(
-        .TDATA_NUM_BYTES(CHANNEL_NUM * 2)
+        .TDATA_NUM_BYTES  (SCAN_NUM * 2),
+        .M_TDATA_NUM_BYTES(M_TDATA_WIDTH / 8)
     ) sample_core_inst (
         .clk            (clk),
         .rst            (soft_rst),
@@ -226,6 +353,129 @@ module ads8684_wrapper #(
         .m_tready       (m_tready)
     );
 
+    // *******************************************************************************
+    // capture buffer, taps the scan stream directly so it runs without dma
+    // *******************************************************************************
+    generate
+        if (C_BUF_DEPTH > 0) begin : gen_capture_buffer
+            capture_buffer #(
+                .TDATA_WIDTH       (SCAN_NUM * 16),
+                .DEPTH             (C_BUF_DEPTH),
+                .C_S_AXI_ADDR_WIDTH(C_S_AXI_ADDR_WIDTH),
+                .C_S_AXI_DATA_WIDTH(C_S_AXI_DATA_WIDTH)
+            ) capture_buffer_inst (
+                .clk          (clk),
+                .rst          (soft_rst),
+                .cfg_enable   (buf_enable),
+                .cfg_release  (buf_release),
+                .sts_full     (buf_full),
+                .sts_wr_bank  (buf_wr_bank),
+                .sts_fill     (buf_fill),
+                .sts_wrap_cnt (buf_wrap_cnt),
+                .sts_overflow (buf_overflow),
+                .s_tdata      (adc_tdata),
+                .s_tvalid     (adc_tvalid),
+                .s_axi_araddr (s_axi_araddr),
+                .s_axi_arlen  (s_axi_arlen),
+                .s_axi_arsize (s_axi_arsize),
+                .s_axi_arburst(s_axi_arburst),
+                .s_axi_arvalid(s_axi_arvalid),
+                .s_axi_arready(s_axi_arready),
+                .s_axi_rdata  (s_axi_rdata),
+                .s_axi_rresp  (s_axi_rresp),
+                .s_axi_rlast  (s_axi_rlast),
+                .s_axi_rvalid (s_axi_rvalid),
+                .s_axi_rready (s_axi_rready)
+            );
+        end else begin : gen_no_capture_buffer
+            assign buf_full      = 2'b00;
+            assign buf_wr_bank   = 1'b0;
+            assign buf_fill      = 0;
+            assign buf_wrap_cnt  = 0;
+            assign buf_overflow  = 1'b0;
+            assign s_axi_arready = 1'b0;
+            assign s_axi_rdata   = 0;
+            assign s_axi_rresp   = 2'b00;
+            assign s_axi_rlast   = 1'b0;
+            assign s_axi_rvalid  = 1'b0;
+        end
+    endgenerate
+
+    // *******************************************************************************
+    // code density histogram
+    // *******************************************************************************
+    generate
+        if (C_HIST_BIN_WIDTH > 0) begin : gen_histogram
+            histogram_core #(
+                .CHANNEL_NUM       (SCAN_NUM),
+                .BIN_WIDTH         (C_HIST_BIN_WIDTH),
+                .C_S_AXI_ADDR_WIDTH(C_S_HIST_ADDR_WIDTH)
+            ) histogram_core_inst (
+                .clk          (clk),
+                .rst          (soft_rst),
+                .cfg_run      (hist_run),
+                .cfg_clear    (hist_clear),
+                .cfg_channel  (hist_channel),
+                .cfg_limit    (hist_limit),
+                .sts_busy     (hist_busy),
+                .sts_done     (hist_done),
+                .sts_count    (hist_count),
+                .s_tdata      (adc_tdata),
+                .s_tvalid     (adc_tvalid),
+                .s_axi_araddr (s_hist_axi_araddr),
+                .s_axi_arlen  (s_hist_axi_arlen),
+                .s_axi_arsize (s_hist_axi_arsize),
+                .s_axi_arburst(s_hist_axi_arburst),
+                .s_axi_arvalid(s_hist_axi_arvalid),
+                .s_axi_arready(s_hist_axi_arready),
+                .s_axi_rdata  (s_hist_axi_rdata),
+                .s_axi_rresp  (s_hist_axi_rresp),
+                .s_axi_rlast  (s_hist_axi_rlast),
+                .s_axi_rvalid (s_hist_axi_rvalid),
+                .s_axi_rready (s_hist_axi_rready)
+            );
+        end else begin : gen_no_histogram
+            assign hist_busy          = 1'b0;
+            assign hist_done          = 1'b0;
+            assign hist_count         = 0;
+            assign s_hist_axi_arready = 1'b0;
+            assign s_hist_axi_rdata   = 0;
+            assign s_hist_axi_rresp   = 2'b00;
+            assign s_hist_axi_rlast   = 1'b0;
+            assign s_hist_axi_rvalid  = 1'b0;
+        end
+    endgenerate
+
+    // *******************************************************************************
+    // per channel statistics
+    // *******************************************************************************
+    generate
+        if (C_STAT_ENABLE) begin : gen_stat
+            ads8684_stat #(
+                .CHANNEL_NUM(SCAN_NUM)
+            ) ads8684_stat_inst (
+                .clk       (clk),
+                .rst       (soft_rst),
+                .cfg_window(stat_window),
+                .sts_min   (stat_min),
+                .sts_max   (stat_max),
+                .sts_sum   (stat_sum),
+                .sts_sumsq (stat_sumsq),
+                .sts_seq   (stat_seq),
+                .sts_done  (stat_done),
+                .s_tdata   (adc_tdata),
+                .s_tvalid  (adc_tvalid)
+            );
+        end else begin : gen_no_stat
+            assign stat_min   = 0;
+            assign stat_max   = 0;
+            assign stat_sum   = 0;
+            assign stat_sumsq = 0;
+            assign stat_seq   = 0;
+            assign stat_done  = 1'b0;
+        end
+    endgenerate
+
 endmodule
 
 // verilog_format: off
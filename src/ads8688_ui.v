@@ -39,7 +39,12 @@
 module ads8688_ui #(
     parameter integer C_APB_ADDR_WIDTH = 16,
     parameter integer C_APB_DATA_WIDTH = 32,
-    parameter integer C_S_BASEADDR     = 0
+    parameter integer C_S_BASEADDR     = 0,
+    parameter integer CHANNEL_NUM      = 4,
+    parameter integer AUX_ENABLE       = 0,
+    parameter integer SCAN_NUM         = CHANNEL_NUM + AUX_ENABLE,
+    parameter integer C_BUF_BANK_SIZE  = 0,
+    parameter integer C_HIST_BIN_NUM   = 0
 ) (
     //
     input  wire                          clk,
@@ -56,6 +61,8 @@ module ads8688_ui #(
     //
     output reg                           baud_load,
     output reg  [                  31:0] baud_div,
+    output reg  [                  31:0] baud_phase,       // SCLK 低电平时钟数, 0: baud_div/2
+    output reg  [                   3:0] miso_delay,       // MISO 采样延迟时钟数
     //
     output reg                           sample_req,
     output reg  [                  31:0] sample_num,
@@ -64,6 +71,30 @@ module ads8688_ui #(
     input  wire                          sample_err,
     input  wire                          sample_done,
     //
+    output wire                          buf_enable,       // 缓存使能
+    output reg  [                   1:0] buf_release,      // 释放缓冲区
+    input  wire [                   1:0] buf_full,         // 缓冲区已写满
+    input  wire                          buf_wr_bank,      // 当前写入的缓冲区
+    input  wire [                  31:0] buf_fill,         // 当前缓冲区写入进度
+    input  wire [                  31:0] buf_wrap_cnt,     // 缓冲区轮转次数
+    input  wire                          buf_overflow,     // 缓冲区溢出
+    //
+    output wire                          hist_run,         // 直方图统计使能
+    output reg                           hist_clear,       // 清空直方图
+    output reg  [                   7:0] hist_channel,     // 直方图统计通道
+    output reg  [                  31:0] hist_limit,       // 直方图统计样本数
+    input  wire                          hist_busy,        // 直方图清空中
+    input  wire                          hist_done,        // 直方图统计完成
+    input  wire [                  31:0] hist_count,       // 直方图已统计样本数
+    //
+    output reg  [                  31:0] stat_window,      // 统计窗口
+    input  wire [     (SCAN_NUM*16-1):0] stat_min,         // 最小值
+    input  wire [     (SCAN_NUM*16-1):0] stat_max,         // 最大值
+    input  wire [     (SCAN_NUM*48-1):0] stat_sum,         // 累加和
+    input  wire [     (SCAN_NUM*64-1):0] stat_sumsq,       // 平方和
+    input  wire [                  31:0] stat_seq,         // 已完成的窗口数
+    input  wire                          stat_done,        // 统计窗口完成
+    //
     output reg  [                   7:0] cfg_addr,         // SPI操作地址
     output reg  [                   7:0] cfg_wr_data,      // SPI写数据
     input  wire [                  15:0] cfg_rd_data,      // SPI读数据
@@ -73,6 +104,7 @@ module ads8688_ui #(
     //
     output wire                          cfg_auto_mode,    // SPI自动扫描
     input  wire [                   7:0] cfg_ch_enable,    //
+    output wire                          cfg_aux_enable,   // AUX 通道扫描使能
     //
     output reg                           sync,             // 同步脉冲
     output reg                           soft_rst,         // 软件复位
@@ -92,6 +124,29 @@ module ads8688_ui #(
     localparam [7:0] ADDR_SAMPLE_NUM    = ADDR_ENABLE_CH    + 8'h4;
     localparam [7:0] ADDR_SAMPLE_CNT    = ADDR_SAMPLE_NUM   + 8'h4;
     localparam [7:0] ADDR_BAUD_DIV      = ADDR_SAMPLE_CNT   + 8'h4;
+    //
+    localparam [7:0] ADDR_BUF_CTRL      = ADDR_BAUD_DIV     + 8'h4;
+    localparam [7:0] ADDR_BUF_STATE     = ADDR_BUF_CTRL     + 8'h4;
+    localparam [7:0] ADDR_BUF_FILL      = ADDR_BUF_STATE    + 8'h4;
+    localparam [7:0] ADDR_BUF_WRAP      = ADDR_BUF_FILL     + 8'h4;
+    localparam [7:0] ADDR_BUF_SIZE      = ADDR_BUF_WRAP     + 8'h4;
+    //
+    localparam [7:0] ADDR_HIST_CTRL     = ADDR_BUF_SIZE     + 8'h4;
+    localparam [7:0] ADDR_HIST_CH       = ADDR_HIST_CTRL    + 8'h4;
+    localparam [7:0] ADDR_HIST_LIMIT    = ADDR_HIST_CH      + 8'h4;
+    localparam [7:0] ADDR_HIST_CNT      = ADDR_HIST_LIMIT   + 8'h4;
+    localparam [7:0] ADDR_HIST_SIZE     = ADDR_HIST_CNT     + 8'h4;
+    //
+    localparam [7:0] ADDR_STAT_WINDOW   = ADDR_HIST_SIZE    + 8'h4;
+    localparam [7:0] ADDR_STAT_SEQ      = ADDR_STAT_WINDOW  + 8'h4;
+    //
+    localparam [7:0] ADDR_CH_NUM        = ADDR_STAT_SEQ     + 8'h4;
+    localparam [7:0] ADDR_SCAN_FRAC     = ADDR_CH_NUM       + 8'h4;
+    localparam [7:0] ADDR_BAUD_PHASE    = ADDR_SCAN_FRAC    + 8'h4;
+    localparam [7:0] ADDR_MISO_DELAY    = ADDR_BAUD_PHASE   + 8'h4;
+    // per channel results, 0x20 bytes each
+    localparam [15:0] ADDR_STAT_BASE    = C_S_BASEADDR + 16'h100;
+    localparam [15:0] ADDR_STAT_END     = ADDR_STAT_BASE + SCAN_NUM * 16'h20;
     // verilog_format: on
 
     reg        rstn_i = 0;
@@ -99,13 +154,25 @@ module ads8688_ui #(
     reg [31:0] ctrl_reg;
     reg [31:0] status_reg;
     reg [31:0] scan_period;
+    reg [31:0] scan_period_m1;
+    reg [31:0] scan_frac;
     reg [31:0] scan_cnt;
+    reg [31:0] frac_acc;
+    reg        frac_carry;
+    reg [31:0] buf_ctrl_reg;
+    reg [31:0] buf_state_reg;
+    reg [31:0] hist_ctrl_reg;
+    reg [31:0] stat_rdata;
+
+    wire        stat_hit;
+    wire [ 7:0] stat_ch;
 
     //------------------------------------------------------------------------------------
 
     localparam [31:0] IPIDENTIFICATION = 32'hF7DEC7A5;
     localparam [31:0] REVISION = "V1.0";
     localparam [31:0] BUILDTIME = 32'h20231013;
+    localparam [31:0] CH_NUM_INFO = (AUX_ENABLE != 0) ? (CHANNEL_NUM | 32'h100) : CHANNEL_NUM;
 
     reg  [                31:0] test_reg;
     wire                        wr_active;
@@ -153,23 +220,55 @@ module ads8688_ui #(
     //-------------------------------------------------------------------------------------------------------------------------------------------
     //Read Register
     //-------------------------------------------------------------------------------------------------------------------------------------------
+    assign stat_hit = (user_reg_raddr >= ADDR_STAT_BASE) && (user_reg_raddr < ADDR_STAT_END);
+    assign stat_ch  = (user_reg_raddr - ADDR_STAT_BASE) >> 5;
+
+    always @(*) begin
+        case (user_reg_raddr[4:2])
+            3'd0:    stat_rdata = {stat_max[stat_ch*16+:16], stat_min[stat_ch*16+:16]};
+            3'd1:    stat_rdata = stat_sum[stat_ch*48+:32];
+            3'd2:    stat_rdata = stat_sum[(stat_ch*48+32)+:16];
+            3'd3:    stat_rdata = stat_sumsq[stat_ch*64+:32];
+            3'd4:    stat_rdata = stat_sumsq[(stat_ch*64+32)+:32];
+            default: stat_rdata = 32'd0;
+        endcase
+    end
+
     always @(posedge clk) begin
         if (soft_rst) begin
             user_reg_rdata <= 32'd0;
         end else begin
             user_reg_rdata <= 32'd0;
-            if (user_reg_rreq) begin
+            if (user_reg_rreq & stat_hit) begin
+                user_reg_rdata <= stat_rdata;
+            end else if (user_reg_rreq) begin
                 case (user_reg_raddr)
                     ADDR_CTRL:        user_reg_rdata <= ctrl_reg;
                     ADDR_STATE:       user_reg_rdata <= status_reg;
                     ADDR_ADDR:        user_reg_rdata <= cfg_addr;
                     ADDR_WR_DATA:     user_reg_rdata <= cfg_wr_data;
                     ADDR_RD_DATA:     user_reg_rdata <= cfg_rd_data;
-                    ADDR_ENABLE_CH:   user_reg_rdata <= cfg_ch_enable;
+                    ADDR_ENABLE_CH:   user_reg_rdata <= {cfg_aux_enable, cfg_ch_enable};
                     ADDR_SCAN_PRRIOD: user_reg_rdata <= scan_period;
                     ADDR_SAMPLE_NUM:  user_reg_rdata <= sample_num;
                     ADDR_SAMPLE_CNT:  user_reg_rdata <= sample_progress;
                     ADDR_BAUD_DIV:    user_reg_rdata <= baud_div;
+                    ADDR_BUF_CTRL:    user_reg_rdata <= buf_ctrl_reg;
+                    ADDR_BUF_STATE:   user_reg_rdata <= buf_state_reg;
+                    ADDR_BUF_FILL:    user_reg_rdata <= buf_fill;
+                    ADDR_BUF_WRAP:    user_reg_rdata <= buf_wrap_cnt;
+                    ADDR_BUF_SIZE:    user_reg_rdata <= C_BUF_BANK_SIZE;
+                    ADDR_HIST_CTRL:   user_reg_rdata <= hist_ctrl_reg;
+                    ADDR_HIST_CH:     user_reg_rdata <= hist_channel;
+                    ADDR_HIST_LIMIT:  user_reg_rdata <= hist_limit;
+                    ADDR_HIST_CNT:    user_reg_rdata <= hist_count;
+                    ADDR_HIST_SIZE:   user_reg_rdata <= C_HIST_BIN_NUM;
+                    ADDR_STAT_WINDOW: user_reg_rdata <= stat_window;
+                    ADDR_STAT_SEQ:    user_reg_rdata <= stat_seq;
+                    ADDR_CH_NUM:      user_reg_rdata <= CH_NUM_INFO;
+                    ADDR_SCAN_FRAC:   user_reg_rdata <= scan_frac;
+                    ADDR_BAUD_PHASE:  user_reg_rdata <= baud_phase;
+                    ADDR_MISO_DELAY:  user_reg_rdata <= miso_delay;
                     default:          user_reg_rdata <= 32'hdeadbeef;
                 endcase
             end
@@ -178,24 +277,42 @@ module ads8688_ui #(
 
     always @(posedge clk) begin
         if (soft_rst) begin
-            cfg_addr    <= 0;
-            cfg_wr_data <= 0;
-            scan_period <= 0;
-            sample_num  <= 0;
-            baud_div    <= 8;
+            cfg_addr     <= 0;
+            cfg_wr_data  <= 0;
+            scan_period  <= 0;
+            scan_frac    <= 0;
+            sample_num   <= 0;
+            baud_div     <= 8;
+            baud_phase   <= 0;
+            miso_delay   <= 0;
+            hist_channel <= 0;
+            hist_limit   <= 0;
+            stat_window  <= 0;
         end else begin
-            cfg_addr    <= cfg_addr;
-            cfg_wr_data <= cfg_wr_data;
-            scan_period <= scan_period;
-            sample_num  <= sample_num;
-            baud_div    <= baud_div;
+            cfg_addr     <= cfg_addr;
+            cfg_wr_data  <= cfg_wr_data;
+            scan_period  <= scan_period;
+            scan_frac    <= scan_frac;
+            sample_num   <= sample_num;
+            baud_div     <= baud_div;
+            baud_phase   <= baud_phase;
+            miso_delay   <= miso_delay;
+            hist_channel <= hist_channel;
+            hist_limit   <= hist_limit;
+            stat_window  <= stat_window;
             if (wr_active) begin
                 case (user_reg_waddr)
                     ADDR_ADDR:        cfg_addr <= user_reg_wdata;
                     ADDR_WR_DATA:     cfg_wr_data <= user_reg_wdata;
                     ADDR_SCAN_PRRIOD: scan_period <= user_reg_wdata;
+                    ADDR_SCAN_FRAC:   scan_frac <= user_reg_wdata;
                     ADDR_SAMPLE_NUM:  sample_num <= user_reg_wdata;
                     ADDR_BAUD_DIV:    baud_div <= user_reg_wdata;
+                    ADDR_BAUD_PHASE:  baud_phase <= user_reg_wdata;
+                    ADDR_MISO_DELAY:  miso_delay <= user_reg_wdata;
+                    ADDR_HIST_CH:     hist_channel <= user_reg_wdata;
+                    ADDR_HIST_LIMIT:  hist_limit <= user_reg_wdata;
+                    ADDR_STAT_WINDOW: stat_window <= user_reg_wdata;
                     default:          ;
                 endcase
             end
@@ -215,6 +332,11 @@ module ads8688_ui #(
                 status_reg[4] <= sample_busy;
                 status_reg[5] <= (status_reg[5] | sample_err) & (~sample_req);
                 status_reg[6] <= (status_reg[6] | sample_done) & (~sample_req);
+
+                status_reg[8] <= hist_busy;
+                status_reg[9] <= (status_reg[9] | hist_done) & (~hist_clear);
+
+                status_reg[10] <= status_reg[10] | stat_done;
             end
         end
     end
@@ -226,7 +348,83 @@ module ads8688_ui #(
             if (wr_active && (user_reg_waddr == ADDR_CTRL)) begin
                 ctrl_reg <= user_reg_wdata;
             end else begin
-                ctrl_reg <= {cfg_auto_mode, adc_refsel, ~adc_rstn, 3'b000, sample_req, 3'b000, cfg_spi_start};
+                ctrl_reg <= {cfg_aux_enable, 1'b0, cfg_auto_mode, adc_refsel, ~adc_rstn, 3'b000, sample_req, 3'b000, cfg_spi_start};
+            end
+        end
+    end
+
+    // *******************************************************************************
+    // capture buffer
+    // *******************************************************************************
+    always @(posedge clk) begin
+        if (soft_rst) begin
+            buf_state_reg <= 0;
+        end else begin
+            if (wr_active && (user_reg_waddr == ADDR_BUF_STATE)) begin
+                buf_state_reg <= buf_state_reg & ~user_reg_wdata;
+            end else begin
+                buf_state_reg[1:0] <= buf_full;
+                buf_state_reg[4]   <= buf_wr_bank;
+                buf_state_reg[8]   <= buf_state_reg[8] | buf_overflow;
+            end
+        end
+    end
+
+    // buf_ctrl[0]
+    always @(posedge clk) begin
+        if (soft_rst) begin
+            buf_ctrl_reg <= 0;
+        end else begin
+            if (wr_active && (user_reg_waddr == ADDR_BUF_CTRL)) begin
+                buf_ctrl_reg <= user_reg_wdata;
+            end else begin
+                buf_ctrl_reg <= {buf_release, 3'b000, buf_enable};
+            end
+        end
+    end
+
+    assign buf_enable = (C_BUF_BANK_SIZE > 0) & buf_ctrl_reg[0];
+
+    // buf_ctrl[5:4]
+    always @(posedge clk) begin
+        if (soft_rst) begin
+            buf_release <= 2'b00;
+        end else begin
+            if (wr_active && (user_reg_waddr == ADDR_BUF_CTRL)) begin
+                buf_release <= user_reg_wdata[5:4];
+            end else begin
+                buf_release <= 2'b00;
+            end
+        end
+    end
+
+    // *******************************************************************************
+    // histogram
+    // *******************************************************************************
+    // hist_ctrl[0]
+    always @(posedge clk) begin
+        if (soft_rst) begin
+            hist_ctrl_reg <= 0;
+        end else begin
+            if (wr_active && (user_reg_waddr == ADDR_HIST_CTRL)) begin
+                hist_ctrl_reg <= user_reg_wdata;
+            end else begin
+                hist_ctrl_reg <= {hist_clear, 3'b000, hist_run};
+            end
+        end
+    end
+
+    assign hist_run = (C_HIST_BIN_NUM > 0) & hist_ctrl_reg[0];
+
+    // hist_ctrl[4]
+    always @(posedge clk) begin
+        if (soft_rst) begin
+            hist_clear <= 1'b0;
+        end else begin
+            if (wr_active && (user_reg_waddr == ADDR_HIST_CTRL) && user_reg_wdata[4]) begin
+                hist_clear <= 1'b1;
+            end else begin
+                hist_clear <= 1'b0;
             end
         end
     end
@@ -278,8 +476,9 @@ module ads8688_ui #(
         end
     end
 
-    assign adc_refsel    = ctrl_reg[9];
-    assign cfg_auto_mode = ctrl_reg[10];
+    assign adc_refsel     = ctrl_reg[9];
+    assign cfg_auto_mode  = ctrl_reg[10];
+    assign cfg_aux_enable = (AUX_ENABLE != 0) & ctrl_reg[12];
 
     // ctrl[11]
     always @(posedge clk) begin
@@ -295,22 +494,39 @@ module ads8688_ui #(
     end
 
 
+    // *******************************************************************************
+    // scan timer, period = scan_period + scan_frac / 2^32 clocks
+    // the fractional part is accumulated once per period and its carry stretches
+    // a following period by one clock, so sync jitter is bounded to one clock and
+    // the average rate is exact
+    // the counter runs down to zero and reloads from a registered value, keeping
+    // adders and magnitude compares out of the per clock path
+    // *******************************************************************************
+    always @(posedge clk) begin
+        scan_period_m1 <= scan_period - 1;
+    end
+
     always @(posedge clk) begin
         if (soft_rst) begin
-            scan_cnt <= 0;
-            sync     <= 1'b0;
+            scan_cnt   <= 0;
+            frac_acc   <= 0;
+            frac_carry <= 1'b0;
+            sync       <= 1'b0;
         end else begin
             if (cfg_auto_mode && (scan_period > 0)) begin
-                if (scan_cnt < scan_period - 1) begin
-                    scan_cnt <= scan_cnt + 1;
+                if (scan_cnt != 0) begin
+                    scan_cnt <= scan_cnt - 1;
                     sync     <= 1'b0;
                 end else begin
-                    scan_cnt <= 0;
-                    sync     <= 1'b1;
+                    scan_cnt               <= frac_carry ? scan_period : scan_period_m1;
+                    {frac_carry, frac_acc} <= frac_acc + scan_frac;
+                    sync                   <= 1'b1;
                 end
             end else begin
-                scan_cnt <= 0;
-                sync     <= 1'b0;
+                scan_cnt   <= scan_period_m1;
+                frac_acc   <= 0;
+                frac_carry <= 1'b0;
+                sync       <= 1'b0;
             end
         end
     end
@@ -0,0 +1,137 @@
+// +FHEADER-------------------------------------------------------------------------------
+// Copyright (c) 2024 john_tito All rights reserved.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+// ---------------------------------------------------------------------------------------
+// Author        : john_tito
+// Module Name   : axi_mem_rd
+// ---------------------------------------------------------------------------------------
+// Revision      : 1.0
+// Description   : AXI4 read only slave, maps burst reads onto a 1-cycle latency
+//                 memory read port (block ram)
+// ---------------------------------------------------------------------------------------
+// Synthesizable : Yes
+// Clock Domains : clk
+// Reset Strategy: sync reset
+// -FHEADER-------------------------------------------------------------------------------
+
+// verilog_format: off
+`resetall
+`timescale 1ns / 1ps
+`default_nettype none
+// verilog_format: on
+
+module axi_mem_rd #(
+    parameter integer C_S_AXI_ADDR_WIDTH = 16,
+    parameter integer C_S_AXI_DATA_WIDTH = 64,
+    parameter integer MEM_ADDR_WIDTH     = 10
+) (
+    input wire clk,
+    input wire rst,
+
+    input  wire [(C_S_AXI_ADDR_WIDTH-1):0] s_axi_araddr,
+    input  wire [                     7:0] s_axi_arlen,
+    input  wire [                     2:0] s_axi_arsize,
+    input  wire [                     1:0] s_axi_arburst,
+    input  wire                            s_axi_arvalid,
+    output wire                            s_axi_arready,
+    output wire [(C_S_AXI_DATA_WIDTH-1):0] s_axi_rdata,
+    output wire [                     1:0] s_axi_rresp,
+    output reg                             s_axi_rlast,
+    output reg                             s_axi_rvalid,
+    input  wire                            s_axi_rready,
+
+    output wire                            mem_rd_en,    // 存储器读使能
+    output wire [    (MEM_ADDR_WIDTH-1):0] mem_rd_addr,  // 存储器读地址 (字地址)
+    input  wire [(C_S_AXI_DATA_WIDTH-1):0] mem_rd_data   // 存储器读数据, 读使能后一拍有效
+);
+
+    localparam integer ADDR_LSB = $clog2(C_S_AXI_DATA_WIDTH / 8);
+
+    reg                        rd_busy;
+    reg                        rd_fixed;
+    reg [                 7:0] rd_left;
+    reg [(MEM_ADDR_WIDTH-1):0] rd_addr;
+
+    // the word address is taken from s_axi_araddr[ADDR_LSB+:MEM_ADDR_WIDTH],
+    // an unknown module stops elaboration when the bus is too narrow for it
+    generate
+        if (C_S_AXI_ADDR_WIDTH < ADDR_LSB + MEM_ADDR_WIDTH) begin : gen_addr_check
+            axi_mem_rd_addr_narrower_than_memory param_check_inst ();
+        end
+    endgenerate
+
+    // only full width transfers are supported, arsize is ignored
+    // WRAP bursts are served as INCR bursts
+    assign s_axi_arready = ~rst & ~rd_busy;
+    assign s_axi_rresp   = 2'b00;
+    assign s_axi_rdata   = mem_rd_data;
+
+    // issue next read whenever the output register is empty or being drained
+    assign mem_rd_en     = rd_busy & (~s_axi_rvalid | s_axi_rready);
+    assign mem_rd_addr   = rd_addr;
+
+    // *******************************************************************************
+    // address channel
+    // *******************************************************************************
+    always @(posedge clk) begin
+        if (rst) begin
+            rd_busy  <= 1'b0;
+            rd_fixed <= 1'b0;
+            rd_left  <= 0;
+            rd_addr  <= 0;
+        end else begin
+            if (s_axi_arvalid & s_axi_arready) begin
+                rd_busy  <= 1'b1;
+                rd_fixed <= (s_axi_arburst == 2'b00);
+                rd_left  <= s_axi_arlen;
+                rd_addr  <= s_axi_araddr[ADDR_LSB+:MEM_ADDR_WIDTH];
+            end else if (mem_rd_en) begin
+                rd_busy <= (rd_left != 0);
+                rd_left <= rd_left - 1;
+                if (~rd_fixed) begin
+                    rd_addr <= rd_addr + 1;
+                end
+            end
+        end
+    end
+
+    // *******************************************************************************
+    // data channel
+    // *******************************************************************************
+    always @(posedge clk) begin
+        if (rst) begin
+            s_axi_rvalid <= 1'b0;
+            s_axi_rlast  <= 1'b0;
+        end else begin
+            if (mem_rd_en) begin
+                s_axi_rvalid <= 1'b1;
+                s_axi_rlast  <= (rd_left == 0);
+            end else if (s_axi_rready) begin
+                s_axi_rvalid <= 1'b0;
+                s_axi_rlast  <= 1'b0;
+            end
+        end
+    end
+
+endmodule
+
+// verilog_format: off
+`resetall
+// verilog_format: on
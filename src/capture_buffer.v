@@ -0,0 +1,198 @@
+// +FHEADER-------------------------------------------------------------------------------
+// Copyright (c) 2024 john_tito All rights reserved.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+// ---------------------------------------------------------------------------------------
+// Author        : john_tito
+// Module Name   : capture_buffer
+// ---------------------------------------------------------------------------------------
+// Revision      : 1.0
+// Description   : ping-pong block ram capture buffer, one scan per memory word,
+//                 a filled bank is read through the axi memory window while the
+//                 other bank is being filled
+// ---------------------------------------------------------------------------------------
+// Synthesizable : Yes
+// Clock Domains : clk
+// Reset Strategy: sync reset
+// -FHEADER-------------------------------------------------------------------------------
+
+// verilog_format: off
+`resetall
+`timescale 1ns / 1ps
+`default_nettype none
+// verilog_format: on
+
+module capture_buffer #(
+    parameter integer TDATA_WIDTH        = 64,
+    parameter integer DEPTH              = 1024,  // 每个缓冲区的深度 (扫描次数), 2 的整数次幂
+    parameter integer C_S_AXI_ADDR_WIDTH = 16,
+    parameter integer C_S_AXI_DATA_WIDTH = 64     // 不小于 TDATA_WIDTH
+) (
+    input wire clk,
+    input wire rst,
+
+    input  wire        cfg_enable,    // 缓存使能, 关闭时写指针归零
+    input  wire [ 1:0] cfg_release,   // 释放已读取的缓冲区
+    output reg  [ 1:0] sts_full,      // 缓冲区已写满
+    output reg         sts_wr_bank,   // 当前正在写入的缓冲区
+    output wire [31:0] sts_fill,      // 当前缓冲区已写入的扫描次数
+    output reg  [31:0] sts_wrap_cnt,  // 两个缓冲区轮转次数
+    output reg         sts_overflow,  // 缓冲区均满时丢弃数据
+
+    input wire [(TDATA_WIDTH-1):0] s_tdata,
+    input wire                     s_tvalid,
+
+    input  wire [(C_S_AXI_ADDR_WIDTH-1):0] s_axi_araddr,
+    input  wire [                     7:0] s_axi_arlen,
+    input  wire [                     2:0] s_axi_arsize,
+    input  wire [                     1:0] s_axi_arburst,
+    input  wire                            s_axi_arvalid,
+    output wire                            s_axi_arready,
+    output wire [(C_S_AXI_DATA_WIDTH-1):0] s_axi_rdata,
+    output wire [                     1:0] s_axi_rresp,
+    output wire                            s_axi_rlast,
+    output wire                            s_axi_rvalid,
+    input  wire                            s_axi_rready
+);
+
+    localparam integer BANK_ADDR_WIDTH = $clog2(DEPTH);
+    localparam integer MEM_ADDR_WIDTH = BANK_ADDR_WIDTH + 1;
+
+    (* ram_style = "block" *)
+    reg  [(C_S_AXI_DATA_WIDTH-1):0] mem         [0:(2*DEPTH-1)];
+
+    reg  [   (BANK_ADDR_WIDTH-1):0] wr_ptr;
+    wire                            wr_en;
+
+    wire                            mem_rd_en;
+    wire [    (MEM_ADDR_WIDTH-1):0] mem_rd_addr;
+    reg  [(C_S_AXI_DATA_WIDTH-1):0] mem_rd_data;
+
+    // a scan must fit in one memory word, an unknown module stops elaboration
+    generate
+        if (TDATA_WIDTH > C_S_AXI_DATA_WIDTH) begin : gen_width_check
+            capture_buffer_tdata_wider_than_axi_data param_check_inst ();
+        end
+    endgenerate
+
+    // bank 1 starts at 2^BANK_ADDR_WIDTH, which is DEPTH only for a power of two
+    generate
+        if ((DEPTH < 2) || ((DEPTH & (DEPTH - 1)) != 0)) begin : gen_depth_check
+            capture_buffer_depth_not_power_of_two param_check_inst ();
+        end
+    endgenerate
+
+    assign wr_en    = cfg_enable & s_tvalid & ~sts_full[sts_wr_bank];
+    assign sts_fill = wr_ptr;
+
+    // *******************************************************************************
+    // write side
+    // *******************************************************************************
+    always @(posedge clk) begin
+        if (wr_en) begin
+            mem[{sts_wr_bank, wr_ptr}] <= s_tdata;
+        end
+    end
+
+    always @(posedge clk) begin
+        if (rst) begin
+            wr_ptr       <= 0;
+            sts_wr_bank  <= 1'b0;
+            sts_wrap_cnt <= 0;
+        end else begin
+            if (~cfg_enable) begin
+                wr_ptr      <= 0;
+                sts_wr_bank <= 1'b0;
+            end else if (wr_en) begin
+                wr_ptr <= wr_ptr + 1;
+                if (wr_ptr == DEPTH - 1) begin
+                    sts_wr_bank <= ~sts_wr_bank;
+                    if (sts_wr_bank) begin
+                        sts_wrap_cnt <= sts_wrap_cnt + 1;
+                    end
+                end
+            end
+        end
+    end
+
+    // *******************************************************************************
+    // bank state, a bank stays full until software releases it
+    // *******************************************************************************
+    genvar ii;
+    generate
+        for (ii = 0; ii < 2; ii = ii + 1) begin
+            always @(posedge clk) begin
+                if (rst) begin
+                    sts_full[ii] <= 1'b0;
+                end else begin
+                    if (wr_en && (sts_wr_bank == ii) && (wr_ptr == DEPTH - 1)) begin
+                        sts_full[ii] <= 1'b1;
+                    end else if (cfg_release[ii]) begin
+                        sts_full[ii] <= 1'b0;
+                    end
+                end
+            end
+        end
+    endgenerate
+
+    always @(posedge clk) begin
+        if (rst) begin
+            sts_overflow <= 1'b0;
+        end else begin
+            sts_overflow <= cfg_enable & s_tvalid & sts_full[sts_wr_bank];
+        end
+    end
+
+    // *******************************************************************************
+    // read side
+    // *******************************************************************************
+    always @(posedge clk) begin
+        if (mem_rd_en) begin
+            mem_rd_data <= mem[mem_rd_addr];
+        end
+    end
+
+    axi_mem_rd #(
+        .C_S_AXI_ADDR_WIDTH(C_S_AXI_ADDR_WIDTH),
+        .C_S_AXI_DATA_WIDTH(C_S_AXI_DATA_WIDTH),
+        .MEM_ADDR_WIDTH    (MEM_ADDR_WIDTH)
+    ) axi_mem_rd_inst (
+        .clk          (clk),
+        .rst          (rst),
+        .s_axi_araddr (s_axi_araddr),
+        .s_axi_arlen  (s_axi_arlen),
+        .s_axi_arsize (s_axi_arsize),
+        .s_axi_arburst(s_axi_arburst),
+        .s_axi_arvalid(s_axi_arvalid),
+        .s_axi_arready(s_axi_arready),
+        .s_axi_rdata  (s_axi_rdata),
+        .s_axi_rresp  (s_axi_rresp),
+        .s_axi_rlast  (s_axi_rlast),
+        .s_axi_rvalid (s_axi_rvalid),
+        .s_axi_rready (s_axi_rready),
+        .mem_rd_en    (mem_rd_en),
+        .mem_rd_addr  (mem_rd_addr),
+        .mem_rd_data  (mem_rd_data)
+    );
+
+endmodule
+
+// verilog_format: off
+`resetall
+// verilog_format: on
@@ -0,0 +1,199 @@
+// +FHEADER-------------------------------------------------------------------------------
+// Copyright (c) 2024 john_tito All rights reserved.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+// ---------------------------------------------------------------------------------------
+// Author        : john_tito
+// Module Name   : histogram_core
+// ---------------------------------------------------------------------------------------
+// Revision      : 1.0
+// Description   : code density histogram of one selected channel, the upper
+//                 BIN_WIDTH bits of each code select a 32 bit bin in block ram
+// ---------------------------------------------------------------------------------------
+// Synthesizable : Yes
+// Clock Domains : clk
+// Reset Strategy: sync reset
+// -FHEADER-------------------------------------------------------------------------------
+
+// verilog_format: off
+`resetall
+`timescale 1ns / 1ps
+`default_nettype none
+// verilog_format: on
+
+module histogram_core #(
+    parameter integer CHANNEL_NUM        = 4,
+    parameter integer BIN_WIDTH          = 16,  // 统计区间数量 2^BIN_WIDTH, 1~16
+    parameter integer C_S_AXI_ADDR_WIDTH = 18
+) (
+    input wire clk,
+    input wire rst,
+
+    input  wire        cfg_run,      // 统计使能
+    input  wire        cfg_clear,    // 清空统计结果
+    input  wire [ 7:0] cfg_channel,  // 统计通道
+    input  wire [31:0] cfg_limit,    // 统计样本数, 0: 不限制
+    output reg         sts_busy,     // 正在清空
+    output reg         sts_done,     // 达到统计样本数
+    output reg  [31:0] sts_count,    // 已统计样本数
+
+    input wire [(CHANNEL_NUM*16-1):0] s_tdata,
+    input wire                        s_tvalid,
+
+    input  wire [(C_S_AXI_ADDR_WIDTH-1):0] s_axi_araddr,
+    input  wire [                     7:0] s_axi_arlen,
+    input  wire [                     2:0] s_axi_arsize,
+    input  wire [                     1:0] s_axi_arburst,
+    input  wire                            s_axi_arvalid,
+    output wire                            s_axi_arready,
+    output wire [                    31:0] s_axi_rdata,
+    output wire [                     1:0] s_axi_rresp,
+    output wire                            s_axi_rlast,
+    output wire                            s_axi_rvalid,
+    input  wire                            s_axi_rready
+);
+
+    localparam integer BIN_NUM = 1 << BIN_WIDTH;
+
+    (* ram_style = "block" *)
+    reg  [           31:0] mem         [0:(BIN_NUM-1)];
+
+    reg  [(BIN_WIDTH-1):0] clr_addr;
+    reg  [(BIN_WIDTH-1):0] bin_addr    [          0:1];
+    reg  [            1:0] upd_en;
+    reg  [           31:0] bin_data;
+    reg  [           15:0] code;
+    wire                   code_valid;
+    wire                   ch_valid;
+    wire                   limit_hit;
+
+    wire                   mem_rd_en;
+    wire [(BIN_WIDTH-1):0] mem_rd_addr;
+    reg  [           31:0] mem_rd_data;
+
+    integer                jj;
+
+    assign limit_hit  = (cfg_limit != 0) && (sts_count >= cfg_limit);
+    // a channel that is not scanned has no code, do not pile it into bin 0
+    assign ch_valid   = (cfg_channel < CHANNEL_NUM);
+    assign code_valid = s_tvalid & cfg_run & ch_valid & ~sts_busy & ~limit_hit;
+
+    // *******************************************************************************
+    // clear all bins
+    // *******************************************************************************
+    always @(posedge clk) begin
+        if (rst) begin
+            sts_busy <= 1'b1;
+            clr_addr <= 0;
+        end else begin
+            if (cfg_clear) begin
+                sts_busy <= 1'b1;
+                clr_addr <= 0;
+            end else if (sts_busy) begin
+                sts_busy <= (clr_addr != BIN_NUM - 1);
+                clr_addr <= clr_addr + 1;
+            end
+        end
+    end
+
+    always @(posedge clk) begin
+        if (rst) begin
+            sts_count <= 0;
+            sts_done  <= 1'b0;
+        end else begin
+            if (sts_busy) begin
+                sts_count <= 0;
+            end else if (code_valid) begin
+                sts_count <= sts_count + 1;
+            end
+            sts_done <= code_valid && (cfg_limit != 0) && (sts_count == cfg_limit - 1);
+        end
+    end
+
+    // *******************************************************************************
+    // read-modify-write, a new code is expected at most once per scan so two
+    // consecutive updates are always far enough apart to need no forwarding
+    // *******************************************************************************
+    always @(*) begin
+        code = 16'h0000;
+        for (jj = 0; jj < CHANNEL_NUM; jj = jj + 1) begin
+            if (cfg_channel == jj) begin
+                code = s_tdata[jj*16+:16];
+            end
+        end
+    end
+
+    always @(posedge clk) begin
+        if (rst) begin
+            upd_en      <= 2'b00;
+            bin_addr[0] <= 0;
+            bin_addr[1] <= 0;
+        end else begin
+            upd_en      <= {upd_en[0], code_valid};
+            bin_addr[0] <= code[15-:BIN_WIDTH];
+            bin_addr[1] <= bin_addr[0];
+        end
+    end
+
+    // port a: clear / update
+    always @(posedge clk) begin
+        if (sts_busy) begin
+            mem[clr_addr] <= 0;
+        end else if (upd_en[1]) begin
+            mem[bin_addr[1]] <= (&bin_data) ? bin_data : bin_data + 1;
+        end else if (upd_en[0]) begin
+            bin_data <= mem[bin_addr[0]];
+        end
+    end
+
+    // port b: memory window
+    always @(posedge clk) begin
+        if (mem_rd_en) begin
+            mem_rd_data <= mem[mem_rd_addr];
+        end
+    end
+
+    axi_mem_rd #(
+        .C_S_AXI_ADDR_WIDTH(C_S_AXI_ADDR_WIDTH),
+        .C_S_AXI_DATA_WIDTH(32),
+        .MEM_ADDR_WIDTH    (BIN_WIDTH)
+    ) axi_mem_rd_inst (
+        .clk          (clk),
+        .rst          (rst),
+        .s_axi_araddr (s_axi_araddr),
+        .s_axi_arlen  (s_axi_arlen),
+        .s_axi_arsize (s_axi_arsize),
+        .s_axi_arburst(s_axi_arburst),
+        .s_axi_arvalid(s_axi_arvalid),
+        .s_axi_arready(s_axi_arready),
+        .s_axi_rdata  (s_axi_rdata),
+        .s_axi_rresp  (s_axi_rresp),
+        .s_axi_rlast  (s_axi_rlast),
+        .s_axi_rvalid (s_axi_rvalid),
+        .s_axi_rready (s_axi_rready),
+        .mem_rd_en    (mem_rd_en),
+        .mem_rd_addr  (mem_rd_addr),
+        .mem_rd_data  (mem_rd_data)
+    );
+
+endmodule
+
+// verilog_format: off
+`resetall
+// verilog_format: on
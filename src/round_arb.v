@@ -22,8 +22,9 @@
 // Author        : john_tito
 // Module Name   : round_arb
 // ---------------------------------------------------------------------------------------
-// Revision      : 1.0
+// Revision      : 1.1
 // Description   : File Created
+//                 1.1 precomputed next channel table
 // ---------------------------------------------------------------------------------------
 // Synthesizable : Yes
 // Clock Domains : clk
@@ -51,84 +52,88 @@ module round_arb #(
     output reg                    roll_over
 );
 
-    integer                     cnt;
+    // *******************************************************************************
+    // ch_enable is quasi static, so the next channel of every index is computed
+    // ahead of time into a table, the per scan path is a single table lookup
+    //   stage 0: register ch_enable
+    //   stage 1: next channel table
+    //   stage 2: lookup by current_index
+    // *******************************************************************************
+    reg [            (CHANNEL_NUM-1):0] en_reg;
+    reg                                 en_any;
 
-    reg     [(INDEX_WIDTH-1):0] max_index;
-    reg     [(INDEX_WIDTH-1):0] min_index;
+    reg [(CHANNEL_NUM*INDEX_WIDTH-1):0] arb_index;
+    reg [            (CHANNEL_NUM-1):0] arb_roll;
 
-    function [INDEX_WIDTH : 0] get_arb(input [INDEX_WIDTH-1:0] current_index, input [CHANNEL_NUM-1:0] arb_req);
-        integer ii;
-        begin
+    always @(posedge clk) begin
+        if (rst) begin
+            en_reg <= 0;
+            en_any <= 1'b0;
+        end else begin
+            en_reg <= ch_enable;
+            en_any <= |ch_enable;
+        end
+    end
 
-            get_arb = {1'b0, current_index};
+    genvar ii;
+    generate
+        for (ii = 0; ii < CHANNEL_NUM; ii = ii + 1) begin : gen_arb_table
+            reg     [(INDEX_WIDTH-1):0] step_index;
+            reg     [(INDEX_WIDTH-1):0] wrap_index;
+            reg                         step_hit;
+            integer                     jj;
 
-            if (SCAN_DIR) begin
-                if (current_index <= min_index) begin
-                    get_arb = {1'b1, max_index};
-                end else if (current_index > max_index) begin
-                    get_arb = {1'b0, max_index};
-                end else begin
-                    for (ii = 0; ii < current_index; ii = ii + 1) begin
-                        if (arb_req[ii]) begin
-                            get_arb = {1'b0, ii[2:0]};
+            // step_index: nearest enabled channel after ii in scan direction
+            // wrap_index: first enabled channel of a new round
+            always @(*) begin
+                step_index = ii;
+                wrap_index = ii;
+                step_hit   = 1'b0;
+                if (SCAN_DIR) begin
+                    for (jj = 0; jj < CHANNEL_NUM; jj = jj + 1) begin
+                        if (en_reg[jj]) begin
+                            wrap_index = jj;
+                            if (jj < ii) begin
+                                step_index = jj;
+                                step_hit   = 1'b1;
+                            end
                         end
                     end
-                end
-            end else begin
-                if (current_index >= max_index) begin
-                    get_arb = {1'b1, min_index};
-                end else if (current_index < min_index) begin
-                    get_arb = {1'b0, min_index};
                 end else begin
-                    for (ii = CHANNEL_NUM - 1; ii > current_index; ii = ii - 1) begin
-                        if (arb_req[ii]) begin
-                            get_arb = {1'b0, ii[2:0]};
+                    for (jj = CHANNEL_NUM - 1; jj >= 0; jj = jj - 1) begin
+                        if (en_reg[jj]) begin
+                            wrap_index = jj;
+                            if (jj > ii) begin
+                                step_index = jj;
+                                step_hit   = 1'b1;
+                            end
                         end
                     end
                 end
             end
-        end
-    endfunction
-
-    function [CHANNEL_NUM-1:0] get_arb_bin(input [INDEX_WIDTH-1:0] current_index, input [CHANNEL_NUM-1:0] arb_req);
-        integer ii;
-        begin
 
-            get_arb_bin = 0;
-
-            if (SCAN_DIR) begin
-                if ((current_index <= min_index) || (current_index > max_index)) begin
-                    get_arb_bin = 1 << max_index;
+            always @(posedge clk) begin
+                if (rst) begin
+                    arb_index[ii*INDEX_WIDTH+:INDEX_WIDTH] <= 0;
+                    arb_roll[ii]                           <= 1'b0;
                 end else begin
-                    for (ii = 0; ii < current_index; ii = ii + 1) begin
-                        if (arb_req[ii]) begin
-                            get_arb_bin = 1'b1 << (CHANNEL_NUM - 1 - ii);
-                        end
-                    end
-                end
-            end else begin
-                if ((current_index >= max_index) || (current_index < min_index)) begin
-                    get_arb_bin = 1 << min_index;
-                end else begin
-                    for (ii = CHANNEL_NUM - 1; ii > current_index; ii = ii - 1) begin
-                        if (arb_req[ii]) begin
-                            get_arb_bin = 1'b1 << ii;
-                        end
-                    end
+                    arb_index[ii*INDEX_WIDTH+:INDEX_WIDTH] <= step_hit ? step_index : wrap_index;
+                    arb_roll[ii]                           <= ~step_hit;
                 end
             end
         end
-    endfunction
+    endgenerate
 
     always @(posedge clk) begin
         if (rst) begin
-            next_index <= 8'h00;
+            next_index <= 0;
             next_bin   <= 0;
             roll_over  <= 1'b0;
         end else begin
-            if (|ch_enable) begin
-                {roll_over, next_index} <= get_arb(current_index, ch_enable);
-                next_bin                <= get_arb_bin(current_index, ch_enable);
+            if (en_any) begin
+                next_index <= arb_index[current_index*INDEX_WIDTH+:INDEX_WIDTH];
+                next_bin   <= 1'b1 << arb_index[current_index*INDEX_WIDTH+:INDEX_WIDTH];
+                roll_over  <= arb_roll[current_index];
             end else begin
                 next_index <= next_index;
                 next_bin   <= 0;
@@ -136,25 +141,6 @@ module round_arb #(
             end
         end
     end
-
-    always @(posedge clk) begin
-        if (rst) begin
-            max_index <= CHANNEL_NUM - 1;
-            min_index <= 0;
-        end else begin
-            for (cnt = CHANNEL_NUM; cnt > 0; cnt = cnt - 1) begin
-                if (ch_enable[cnt-1]) begin
-                    min_index <= cnt - 1;
-                end
-            end
-
-            for (cnt = 0; cnt < CHANNEL_NUM; cnt = cnt + 1) begin
-                if (ch_enable[cnt]) begin
-                    max_index <= cnt;
-                end
-            end
-        end
-    end
 endmodule
 
 // verilog_format: off
@@ -37,7 +37,8 @@
 // verilog_format: on
 
 module sample_core #(
-    parameter integer TDATA_NUM_BYTES = 16
+    parameter integer TDATA_NUM_BYTES   = 16,
+    parameter integer M_TDATA_NUM_BYTES = TDATA_NUM_BYTES  // 不小于 TDATA_NUM_BYTES, 扫描可跨拍拼接
 ) (
     input wire clk,
     input wire rst,
@@ -52,23 +53,60 @@ module sample_core #(
     input wire [(TDATA_NUM_BYTES*8-1):0] s_tdata,
     input wire                           s_tvalid,
 
-    output reg  [(TDATA_NUM_BYTES*8-1):0] m_tdata,
-    output reg  [(  TDATA_NUM_BYTES-1):0] m_tkeep,
-    output reg                            m_tvalid,
-    output reg                            m_tlast,
-    input  wire                           m_tready
+    output reg  [(M_TDATA_NUM_BYTES*8-1):0] m_tdata,
+    output reg  [(  M_TDATA_NUM_BYTES-1):0] m_tkeep,
+    output reg                              m_tvalid,
+    output reg                              m_tlast,
+    input  wire                             m_tready
 );
 
-    reg [31:0] sample_cnt;
+    localparam integer ACC_NUM_BYTES = M_TDATA_NUM_BYTES + TDATA_NUM_BYTES;
+    localparam integer FILL_WIDTH = $clog2(ACC_NUM_BYTES) + 1;
+
+    reg  [                     31:0] sample_cnt;
+    reg  [         (FILL_WIDTH-1):0] pack_fill;
+    reg  [    (ACC_NUM_BYTES*8-1):0] pack_data;
+    wire [         (FILL_WIDTH-1):0] pack_fill_next;
+    wire [    (ACC_NUM_BYTES*8-1):0] pack_data_next;
+    wire                             pack_in;
+    wire                             pack_last;
+    wire                             pack_full;
+    wire                             pack_out;
+    reg                              pack_flush;
+    wire                             flush_out;
+
+    // the output beat holds at least one scan, an unknown module stops
+    // elaboration otherwise
+    generate
+        if (M_TDATA_NUM_BYTES < TDATA_NUM_BYTES) begin : gen_width_check
+            sample_core_m_tdata_narrower_than_scan param_check_inst ();
+        end
+    endgenerate
+
+    // every scan counts once when it is taken in, the beat carrying the last
+    // scan is flushed even if it is only partially filled
+    assign pack_in   = s_tvalid & (sample_cnt > 0);
+    assign pack_last = (sample_cnt == 1);
+
+    // scans are appended byte wise, first scan in the lowest bytes, a scan that
+    // does not fit the current beat straddles into the next one
+    assign pack_data_next = pack_data | ({{(M_TDATA_NUM_BYTES * 8) {1'b0}}, s_tdata} << (pack_fill * 8));
+    assign pack_fill_next = pack_fill + TDATA_NUM_BYTES;
+    assign pack_full      = (pack_fill_next >= M_TDATA_NUM_BYTES);
+    assign pack_out       = pack_in & (pack_full | pack_last);
+
+    // the last scan left bytes over for one more, partial, beat
+    assign flush_out      = pack_flush & (~m_tvalid | m_tready);
+
     always @(posedge clk) begin
         if (rst) begin
             sample_cnt <= 0;
         end else begin
             if (sample_cnt > 0) begin
-                if (m_tvalid & m_tready) begin
+                if (pack_in) begin
                     sample_cnt <= sample_cnt - 1;
                 end
-            end else if (sample_cnt == 0 && sample_req) begin
+            end else if (sample_cnt == 0 && sample_req && ~pack_flush) begin
                 sample_cnt <= sample_num;
             end
         end
@@ -81,9 +119,41 @@ module sample_core #(
             sample_err  <= 0;
             sample_done <= 0;
         end else begin
-            sample_busy <= (sample_cnt > 0);
+            sample_busy <= (sample_cnt > 0) | pack_flush | m_tvalid;
             sample_err  <= (~sample_req) & (m_tvalid & ~m_tready);
-            sample_done <= (~sample_req) & ((sample_cnt == 1) && (m_tvalid & m_tready));
+            sample_done <= (~sample_req) & (m_tvalid & m_tready & m_tlast);
+        end
+    end
+
+    // *******************************************************************************
+    // pack consecutive scans into output beats
+    // *******************************************************************************
+    always @(posedge clk) begin
+        if (rst) begin
+            pack_fill  <= 0;
+            pack_data  <= 0;
+            pack_flush <= 1'b0;
+        end else begin
+            if (flush_out) begin
+                pack_fill  <= 0;
+                pack_data  <= 0;
+                pack_flush <= 1'b0;
+            end else if (pack_in) begin
+                if (pack_full) begin
+                    pack_fill  <= pack_fill_next - M_TDATA_NUM_BYTES;
+                    pack_data  <= pack_data_next >> (M_TDATA_NUM_BYTES * 8);
+                    pack_flush <= pack_last & (pack_fill_next != M_TDATA_NUM_BYTES);
+                end else if (pack_last) begin
+                    pack_fill <= 0;
+                    pack_data <= 0;
+                end else begin
+                    pack_fill <= pack_fill_next;
+                    pack_data <= pack_data_next;
+                end
+            end else if (sample_cnt == 0 && ~pack_flush) begin
+                pack_fill <= 0;
+                pack_data <= 0;
+            end
         end
     end
 
@@ -94,14 +164,19 @@ module sample_core #(
             m_tdata  <= 0;
             m_tkeep  <= 0;
         end else begin
-            if (s_tvalid) begin
-                m_tvalid <= s_tvalid & (sample_cnt > 0);
-                m_tlast  <= (sample_cnt == 1);
-                m_tdata  <= s_tdata;
-                m_tkeep  <= {TDATA_NUM_BYTES{1'b1}};
+            if (pack_out) begin
+                m_tvalid <= 1'b1;
+                m_tlast  <= pack_last & (pack_fill_next <= M_TDATA_NUM_BYTES);
+                m_tdata  <= pack_data_next[(M_TDATA_NUM_BYTES*8-1):0];
+                m_tkeep  <= pack_full ? {M_TDATA_NUM_BYTES{1'b1}} : ({M_TDATA_NUM_BYTES{1'b1}} >> (M_TDATA_NUM_BYTES - pack_fill_next));
+            end else if (flush_out) begin
+                m_tvalid <= 1'b1;
+                m_tlast  <= 1'b1;
+                m_tdata  <= pack_data[(M_TDATA_NUM_BYTES*8-1):0];
+                m_tkeep  <= {M_TDATA_NUM_BYTES{1'b1}} >> (M_TDATA_NUM_BYTES - pack_fill);
             end else if (m_tready) begin
-                m_tvalid <= s_tvalid & (sample_cnt > 1);
-                m_tlast  <= (sample_cnt == 1);
+                m_tvalid <= 1'b0;
+                m_tlast  <= 1'b0;
                 m_tdata  <= 0;
                 m_tkeep  <= 0;
             end
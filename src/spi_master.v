@@ -38,6 +38,7 @@
 
 module spi_master #(
     parameter integer DEFAULT_BAUD_DIV = 8,
+    parameter integer BAUD_WIDTH       = 16,  // 分频计数器位宽, 限制 baud_div 的最大值
     parameter integer DATA_WIDTH       = 8,
     parameter         CPOL             = 1'b0,
     parameter         CPHA             = 1'b0,
@@ -49,6 +50,8 @@ module spi_master #(
 
     input wire        load,
     input wire [31:0] baud_div,
+    input wire [31:0] baud_phase,  // 采样沿到输出沿的时钟数, 0: baud_div/2
+    input wire [ 3:0] miso_delay,  // MISO 采样延迟时钟数, 补偿线路往返延迟
 
     output reg                    spi_scsn = 1,
     output reg                    spi_sclk = CPOL,
@@ -71,6 +74,7 @@ module spi_master #(
     localparam [3:0] FSM_DATA1 = FSM_DATA0 + 1;
     localparam [3:0] FSM_LSB0 = FSM_DATA1 + 1;
     localparam [3:0] FSM_LSB1 = FSM_LSB0 + 1;
+    localparam [3:0] FSM_POST = FSM_LSB1 + 1;
 
     reg  [             3:0] c_state;
     reg  [             3:0] n_state;
@@ -85,8 +89,16 @@ module spi_master #(
     wire                    new_valid;
     reg  [(DATA_WIDTH-1):0] tx_data_latch;
 
-    reg  [            31:0] baud_div_reg  [0:1];
-    reg  [            31:0] counter;
+    reg  [(BAUD_WIDTH-1):0] baud_div_reg  [0:1];
+    reg  [(BAUD_WIDTH-1):0] counter;
+
+    reg  [             3:0] miso_delay_reg;
+    reg  [            15:0] cap_dly;
+    wire                    cap_req;
+    wire                    cap_en;
+    wire                    cap_last;
+    reg  [             7:0] cap_cnt;
+    reg                     cap_done;
 
     always @(posedge clk) begin
         if (rst) begin
@@ -156,11 +168,22 @@ module spi_master #(
                 end
                 FSM_LSB1: begin
                     if (shift_en_0) begin
-                        n_state = FSM_IDLE;
+                        if (cap_done) begin
+                            n_state = FSM_IDLE;
+                        end else begin
+                            n_state = FSM_POST;
+                        end
                     end else begin
                         n_state = FSM_LSB1;
                     end
                 end
+                FSM_POST: begin
+                    if (cap_done) begin
+                        n_state = FSM_IDLE;
+                    end else begin
+                        n_state = FSM_POST;
+                    end
+                end
                 default: n_state = FSM_IDLE;
             endcase
         end
@@ -228,7 +251,7 @@ module spi_master #(
             spi_scsn <= 1'b1;
         end else begin
             case (n_state)
-                FSM_FSB0, FSM_FSB1, FSM_DATA0, FSM_DATA1, FSM_LSB0, FSM_LSB1: begin
+                FSM_FSB0, FSM_FSB1, FSM_DATA0, FSM_DATA1, FSM_LSB0, FSM_LSB1, FSM_POST: begin
                     spi_scsn <= 1'b0;
                 end
                 default: begin
@@ -290,31 +313,51 @@ module spi_master #(
         end
     end
 
-    // clear data when lsat bit shift in
+    // *******************************************************************************
+    // miso capture, the capture strobe follows the sampling edge by miso_delay
+    // clocks, cs is held low in FSM_POST until the last delayed bit is in
+    // *******************************************************************************
+    assign cap_req  = shift_en_1 & ((n_state == FSM_FSB1) | (n_state == FSM_DATA1) | (n_state == FSM_LSB1));
+    assign cap_en   = (miso_delay_reg == 0) ? cap_req : cap_dly[miso_delay_reg-1];
+    assign cap_last = cap_en & (cap_cnt >= DATA_WIDTH - BIT_WIDTH);
+
+    always @(posedge clk) begin
+        if (rst) begin
+            cap_dly <= 0;
+        end else begin
+            cap_dly <= {cap_dly[14:0], cap_req};
+        end
+    end
+
+    always @(posedge clk) begin
+        if (rst) begin
+            cap_cnt  <= 0;
+            cap_done <= 1'b0;
+        end else begin
+            if (n_state == FSM_PRE) begin
+                cap_cnt  <= 0;
+                cap_done <= 1'b0;
+            end else if (cap_en) begin
+                cap_cnt  <= cap_cnt + BIT_WIDTH;
+                cap_done <= cap_last;
+            end
+        end
+    end
+
+    // clear data when frame start
     always @(posedge clk) begin
         if (rst) begin
             spi_rx_buff <= 0;
         end else begin
-            case (n_state)
-                FSM_PRE: begin
-                    spi_rx_buff <= 0;
-                end
-                FSM_FSB0, FSM_DATA0, FSM_LSB0: begin
-                    spi_rx_buff <= spi_rx_buff;
-                end
-                FSM_FSB1, FSM_DATA1, FSM_LSB1: begin
-                    if (shift_en_1) begin
-                        if (MSB) begin
-                            spi_rx_buff <= (spi_rx_buff << BIT_WIDTH) | spi_miso;
-                        end else begin
-                            spi_rx_buff <= {spi_miso, spi_rx_buff[(DATA_WIDTH-1):BIT_WIDTH]};
-                        end
-                    end
+            if (n_state == FSM_PRE) begin
+                spi_rx_buff <= 0;
+            end else if (cap_en) begin
+                if (MSB) begin
+                    spi_rx_buff <= (spi_rx_buff << BIT_WIDTH) | spi_miso;
+                end else begin
+                    spi_rx_buff <= {spi_miso, spi_rx_buff[(DATA_WIDTH-1):BIT_WIDTH]};
                 end
-                default: begin
-                    spi_rx_buff <= 0;
-                end
-            endcase
+            end
         end
     end
 
@@ -324,22 +367,14 @@ module spi_master #(
             rx_data  <= 0;
             rx_valid <= 1'b0;
         end else begin
-            case (n_state)
-                FSM_LSB1: begin
-                    if (shift_en_1) begin
-                        if (MSB) begin
-                            rx_data <= (spi_rx_buff << BIT_WIDTH) | spi_miso;
-                        end else begin
-                            rx_data <= {spi_miso, spi_rx_buff[(DATA_WIDTH-1):BIT_WIDTH]};
-                        end
-                    end
-                    rx_valid <= shift_en_1;
-                end
-                default: begin
-                    rx_data  <= 0;
-                    rx_valid <= 1'b0;
+            if (cap_last) begin
+                if (MSB) begin
+                    rx_data <= (spi_rx_buff << BIT_WIDTH) | spi_miso;
+                end else begin
+                    rx_data <= {spi_miso, spi_rx_buff[(DATA_WIDTH-1):BIT_WIDTH]};
                 end
-            endcase
+            end
+            rx_valid <= cap_last;
         end
     end
 
@@ -376,17 +411,24 @@ module spi_master #(
         if (rst) begin
             baud_div_reg[0] <= DEFAULT_BAUD_DIV;
             baud_div_reg[1] <= DEFAULT_BAUD_DIV / 2;
+            miso_delay_reg  <= 0;
         end else if (load) begin
-            if (baud_div > 1) begin
+            // divisors that do not fit the counter are ignored
+            if ((baud_div > 1) && ((baud_div >> BAUD_WIDTH) == 0)) begin
                 baud_div_reg[0] <= baud_div;
-                baud_div_reg[1] <= baud_div[31:1];
+                if ((baud_phase != 0) && (baud_phase < baud_div)) begin
+                    baud_div_reg[1] <= baud_phase;
+                end else begin
+                    baud_div_reg[1] <= baud_div[31:1];
+                end
             end
+            miso_delay_reg <= miso_delay;
         end
     end
 
     always @(posedge clk) begin
         if (rst) begin
-            counter    <= 16'b0;
+            counter    <= 0;
             shift_en_0 <= 1'b0;
             shift_en_1 <= 1'b0;
         end else begin
@@ -401,7 +443,7 @@ module spi_master #(
                     shift_en_1 <= (counter == baud_div_reg[0]);
                 end
                 default: begin
-                    counter    <= 16'b0;
+                    counter    <= 0;
                     shift_en_0 <= 1'b0;
                     shift_en_1 <= 1'b0;
                 end